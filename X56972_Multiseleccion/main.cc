@@ -1,8 +1,63 @@
 #include <iostream>
 #include <vector>
+#include <string>
+#include <algorithm>
+#include <type_traits>
 
 using namespace std;
 
+#ifdef INSTRUMENT
+#include <chrono>
+#include <cstdio>
+
+/**
+ * Counters of the selection, written as JSON to the standard error when the program exits.
+ * Only compiled with -DINSTRUMENT (make instrument). Otherwise, the STAT_* macros expand to
+ * nothing and the solver is not modified at all.
+ */
+struct Statistics
+{
+    long long comparisons, swaps, partitions;
+    int depth, max_depth;
+    double read_ms, select_ms, print_ms;
+    
+    ~Statistics()
+    {
+        fprintf(stderr, "{\"comparisons\": %lld, \"swaps\": %lld, \"partitions\": %lld, "
+                "\"max_depth\": %d, \"read_ms\": %.3f, \"select_ms\": %.3f, "
+                "\"print_ms\": %.3f}\n", comparisons, swaps, partitions, max_depth,
+                read_ms, select_ms, print_ms);
+    }
+} statistics;
+
+/**
+ * Adds the time elapsed during its lifetime to a phase of the statistics.
+ */
+struct PhaseTimer
+{
+    double &total;
+    chrono::steady_clock::time_point start;
+    
+    PhaseTimer(double &total) : total(total), start(chrono::steady_clock::now())
+    { }
+    
+    ~PhaseTimer()
+    {
+        total += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+};
+
+#define STAT_ADD(counter, value) (statistics.counter += (value))
+#define STAT_ENTER() (statistics.max_depth = max(statistics.max_depth, ++statistics.depth))
+#define STAT_LEAVE() (--statistics.depth)
+#define STAT_PHASE(phase) PhaseTimer phase##_timer(statistics.phase##_ms)
+#else
+#define STAT_ADD(counter, value) ((void) 0)
+#define STAT_ENTER() ((void) 0)
+#define STAT_LEAVE() ((void) 0)
+#define STAT_PHASE(phase)
+#endif
+
 /**
  * Selects the pivot between start, end and (start + end) / 2.
  * Puts the pivot at end position.
@@ -16,6 +71,8 @@ template<class T> inline T selectPivot(vector<T> &elements, int start, int end)
 {
     int center = (start + end) / 2;
     
+    STAT_ADD(comparisons, 3);
+    
     if(elements[end] < elements[center])
         swap(elements[center], elements[start]);
     
@@ -45,19 +102,25 @@ template<class T> int partition(vector<T> &elements, int start, int end)
     T p = selectPivot(elements, start, end);
     int i = start;
     int j = end;
+    
+    STAT_ADD(partitions, 1);
 
     while(i < j)
     {
-        while(i < j and elements[i] <= p)
+        while(i < j and (STAT_ADD(comparisons, 1), elements[i] <= p))
             i++;
         
-        while(i < j and elements[j] >= p)
+        while(i < j and (STAT_ADD(comparisons, 1), elements[j] >= p))
             j--;
         
         if(i < j)
+        {
+            STAT_ADD(swaps, 1);
             swap(elements[i], elements[j]);
+        }
     }
     
+    STAT_ADD(swaps, 1);
     swap(elements[end], elements[j]);
     
     return j;
@@ -114,6 +177,8 @@ template<class T> void multiselect(vector<T> &elements, const vector<int> &ranks
     if(rankStart > rankEnd || elementStart >= elementEnd)
         return;
     
+    STAT_ENTER();
+    
     // We need to show: n = h+1 => multiselect works correctly
     // Thus, we suppose n = h+1
     // Select a pivot with index k and partitionate the elements vector
@@ -163,6 +228,8 @@ template<class T> void multiselect(vector<T> &elements, const vector<int> &ranks
         
         // It was proven before that this call works by induction hypothesis. 
     }
+    
+    STAT_LEAVE();
 }
 
 /**
@@ -176,6 +243,384 @@ template<class T> void multiselect(vector<T> &elements, const vector<int> &ranks
     multiselect(elements, ranks, 0, elements.size() - 1, 0, ranks.size() - 1);
 }
 
+/**
+ * Element of a weighted multiselection: a value that appears weight times.
+ * Elements are compared by value, so selectPivot() and partition() work on them.
+ */
+template<class T> struct Weighted
+{
+    T value;
+    long long weight;
+    
+    bool operator<(const Weighted &other) const { return value < other.value; }
+    bool operator<=(const Weighted &other) const { return value <= other.value; }
+    bool operator>=(const Weighted &other) const { return value >= other.value; }
+};
+
+/**
+ * Reads a weighted element: its value and its weight.
+ */
+template<class T> istream& operator>>(istream &in, Weighted<T> &element)
+{
+    return in >> element.value >> element.weight;
+}
+
+/**
+ * Resolves the weighted multiselection problem: the elements are sorted by value and every
+ * element fills weight consecutive positions, so the r-smallest element is the one whose
+ * positions contain r.
+ * So after applying this function:
+ *      rankStart <= i <= rankEnd => selected[i] is the ranks[i]-smallest element
+ * Where the ranks are relative to the weight of all the elements, and offset is the total
+ * weight of the elements smaller than elements[elementStart..elementEnd].
+ * Cost: O(m log(rankEnd - rankStart)), where m = elementEnd - elementStart + 1
+ * This is the cost of multiselect() on the m distinct elements, instead of on the sum of
+ * their weights.
+ * @param elements Weighted elements vector
+ * @param ranks Ranks to select, sorted
+ * @param selected Destination of the selected values
+ * @param elementStart Element start index
+ * @param elementEnd Element end index
+ * @param rankStart Rank start index
+ * @param rankEnd Rank end index
+ * @param offset Weight of the elements smaller than the elements of the range
+ */
+template<class T> void multiselect(vector< Weighted<T> > &elements, const vector<long long> &ranks,
+        vector<T> &selected, int elementStart, int elementEnd, int rankStart, int rankEnd,
+        long long offset)
+{
+    if(rankStart > rankEnd || elementStart > elementEnd)
+        return;
+    
+    STAT_ENTER();
+    
+    // Same as multiselect(), but the pivot does not hold a single position: it holds the
+    // positions [first, last) after the weight of the elements smaller than it
+    int k = partition(elements, elementStart, elementEnd);
+    
+    long long first = offset;
+    
+    for(int i = elementStart; i < k; ++i)
+        first += elements[i].weight;
+    
+    long long last = first + elements[k].weight;
+    
+    // Ranks before the pivot, ranks held by the pivot and ranks after the pivot
+    vector<long long>::const_iterator end = ranks.begin() + rankEnd + 1;
+    
+    int l = lower_bound(ranks.begin() + rankStart, end, first) - ranks.begin();
+    int h = lower_bound(ranks.begin() + l, end, last) - ranks.begin();
+    
+    for(int i = l; i < h; ++i)
+        selected[i] = elements[k].value;
+    
+    multiselect(elements, ranks, selected, elementStart, k-1, rankStart, l-1, offset);
+    multiselect(elements, ranks, selected, k+1, elementEnd, h, rankEnd, last);
+    
+    STAT_LEAVE();
+}
+
+/**
+ * Solves the weighted multiselection problem.
+ * Simple shortcut for immersion.
+ * @param elements Weighted elements vector
+ * @param ranks Ranks to select, sorted
+ * @return The selected value of every rank
+ */
+template<class T> vector<T> multiselect(vector< Weighted<T> > &elements,
+        const vector<long long> &ranks)
+{
+    vector<T> selected(ranks.size());
+    multiselect(elements, ranks, selected, 0, elements.size() - 1, 0, ranks.size() - 1, 0);
+    
+    return selected;
+}
+
+/**
+ * Sorted range elements[start..end-1] of an elements vector.
+ */
+struct Run
+{
+    int start, end;
+    
+    Run(int start, int end) : start(start), end(end)
+    { }
+};
+
+/**
+ * Splits the elements vector in maximal sorted runs, either ascending or descending.
+ * Descending runs are reversed, so all the runs become ascending.
+ * Gives up as soon as there are more than limit runs, because then the elements are not
+ * nearly sorted. On random elements, runs are very short and this happens after scanning
+ * about 2 * limit elements.
+ * Cost: O(n)
+ * @param elements Elements vector
+ * @param runs Destination of the runs, in order
+ * @param limit Maximum number of runs
+ * @return True if the elements have at most limit runs
+ */
+template<class T> bool find_runs(vector<T> &elements, vector<Run> &runs, int limit)
+{
+    int n = elements.size();
+    int start = 0;
+    
+    runs.clear();
+    
+    while(start < n)
+    {
+        if(runs.size() == limit)
+            return false;
+        
+        int end = start + 1;
+        
+        if(end < n and (STAT_ADD(comparisons, 1), elements[end] < elements[start]))
+        {
+            while(end < n and (STAT_ADD(comparisons, 1), elements[end] <= elements[end-1]))
+                end++;
+            
+            STAT_ADD(swaps, (end - start) / 2);
+            reverse(elements.begin() + start, elements.begin() + end);
+        }
+        else
+        {
+            while(end < n and (STAT_ADD(comparisons, 1), elements[end-1] <= elements[end]))
+                end++;
+        }
+        
+        runs.push_back(Run(start, end));
+        start = end;
+    }
+    
+    return true;
+}
+
+/**
+ * Minimum average size of the runs for multiselect() on runs to keep splitting them.
+ */
+const int RUN_GATHER = 64;
+
+/**
+ * Resolves the multiselection problem on elements split in sorted runs, without moving
+ * any element.
+ * So after applying this function:
+ *      rankStart <= i <= rankEnd => selected[i] is the ranks[i]-smallest element of the runs
+ * Where offset is the number of elements smaller than all the elements of the runs.
+ * 
+ * It works like multiselect(), but a pivot splits every run with two binary searches
+ * instead of partitioning the elements. The pivot is the weighted median of the medians of
+ * the runs: runs holding at least half of the elements have their median <= pivot, so at
+ * least a quarter of the elements are <= pivot, and the same holds for >=. Thus, every
+ * call discards at least a quarter of the elements.
+ * 
+ * Cost: O(r log n) for every call, where r is the number of runs and n the number of
+ * elements, and O(log n) nested calls for every rank.
+ * A single run answers its ranks directly. When the runs have less than RUN_GATHER elements
+ * on average, their elements are copied and the ranks selected on the copy instead.
+ * @param elements Elements vector
+ * @param runs Ascending runs of elements to select from
+ * @param ranks Ranks to select, sorted
+ * @param selected Destination of the selected elements
+ * @param rankStart Rank start index
+ * @param rankEnd Rank end index
+ * @param offset Number of elements smaller than the elements of the runs
+ */
+template<class T> void multiselect(const vector<T> &elements, const vector<Run> &runs,
+        const vector<int> &ranks, vector<T> &selected, int rankStart, int rankEnd, int offset)
+{
+    if(rankStart > rankEnd || runs.empty())
+        return;
+    
+    // A single run is sorted: it answers the ranks directly
+    if(runs.size() == 1)
+    {
+        for(int i = rankStart; i <= rankEnd; ++i)
+            selected[i] = elements[runs[0].start + ranks[i] - offset];
+        
+        return;
+    }
+    
+    int total = 0;
+    
+    for(int r = 0; r < runs.size(); ++r)
+        total += runs[r].end - runs[r].start;
+    
+    // Runs too short to be worth the binary searches: select on a copy of their elements
+    if(total <= RUN_GATHER * runs.size())
+    {
+        vector<T> copy;
+        vector<int> local(ranks.begin() + rankStart, ranks.begin() + rankEnd + 1);
+        
+        for(int r = 0; r < runs.size(); ++r)
+            copy.insert(copy.end(), elements.begin() + runs[r].start,
+                    elements.begin() + runs[r].end);
+        
+        for(int i = 0; i < local.size(); ++i)
+            local[i] -= offset;
+        
+        multiselect(copy, local);
+        
+        for(int i = 0; i < local.size(); ++i)
+            selected[rankStart + i] = copy[local[i]];
+        
+        return;
+    }
+    
+    STAT_ENTER();
+    STAT_ADD(partitions, 1);
+    
+    // Weighted median of the medians of the runs
+    vector< pair<T, int> > medians;
+    
+    for(int r = 0; r < runs.size(); ++r)
+    {
+        int size = runs[r].end - runs[r].start;
+        medians.push_back(make_pair(elements[runs[r].start + (size - 1) / 2], size));
+    }
+    
+    sort(medians.begin(), medians.end());
+    
+    int m = 0;
+    
+    for(int weight = medians[0].second; 2 * weight < total; weight += medians[m].second)
+        m++;
+    
+    T p = medians[m].first;
+    
+    // Split every run in the elements < p, == p and > p
+    vector<Run> smaller, greater;
+    int less = 0, equal = 0;
+    
+    for(int r = 0; r < runs.size(); ++r)
+    {
+        typename vector<T>::const_iterator start = elements.begin() + runs[r].start;
+        typename vector<T>::const_iterator end = elements.begin() + runs[r].end;
+        
+        int lower = lower_bound(start, end, p) - elements.begin();
+        int upper = upper_bound(start, end, p) - elements.begin();
+        
+        less += lower - runs[r].start;
+        equal += upper - lower;
+        
+        if(runs[r].start < lower)
+            smaller.push_back(Run(runs[r].start, lower));
+        
+        if(upper < runs[r].end)
+            greater.push_back(Run(upper, runs[r].end));
+    }
+    
+    // Ranks before p, ranks of p and ranks after p
+    vector<int>::const_iterator end = ranks.begin() + rankEnd + 1;
+    
+    int l = lower_bound(ranks.begin() + rankStart, end, offset + less) - ranks.begin();
+    int h = lower_bound(ranks.begin() + l, end, offset + less + equal) - ranks.begin();
+    
+    for(int i = l; i < h; ++i)
+        selected[i] = p;
+    
+    multiselect(elements, smaller, ranks, selected, rankStart, l-1, offset);
+    multiselect(elements, greater, ranks, selected, h, rankEnd, offset + less + equal);
+    
+    STAT_LEAVE();
+}
+
+/**
+ * Maximum number of runs of n elements for adaptive_multiselect() to select on the runs:
+ * n / RUN_RATIO + 1.
+ */
+const int RUN_RATIO = 64;
+
+/**
+ * Solves the multiselection problem, taking advantage of presorted elements.
+ * If the elements are split in few sorted runs (see find_runs()), the ranks are selected on
+ * the runs, which only reads O(r log^2 n) elements and does not move any (except to reverse
+ * descending runs). Otherwise, it falls back to multiselect().
+ * Cost: O(n) to find the runs, plus the cost of the selection
+ * @param elements Elements vector
+ * @param ranks Ranks to select, sorted
+ * @return The selected element of every rank
+ */
+template<class T> vector<T> adaptive_multiselect(vector<T> &elements, const vector<int> &ranks)
+{
+    vector<T> selected(ranks.size());
+    vector<Run> runs;
+    
+    if(find_runs(elements, runs, elements.size() / RUN_RATIO + 1))
+        multiselect(elements, runs, ranks, selected, 0, ranks.size() - 1, 0);
+    else
+    {
+        multiselect(elements, ranks);
+        
+        for(int i = 0; i < ranks.size(); ++i)
+            selected[i] = elements[ranks[i]];
+    }
+    
+    return selected;
+}
+
+/**
+ * Key of a record together with the position of the record.
+ * Compared by key and then by position, so equal keys keep the order of their records and
+ * every record has a different rank.
+ */
+template<class T> struct Indexed
+{
+    T key;
+    int index;
+    
+    bool operator<(const Indexed &other) const
+    {
+        return key < other.key or (not (other.key < key) and index < other.index);
+    }
+    
+    bool operator<=(const Indexed &other) const { return not (other < *this); }
+    bool operator>=(const Indexed &other) const { return not (*this < other); }
+};
+
+/**
+ * Solves the multiselection problem on the keys of some records, without moving the records.
+ * The keys are copied with their positions in a compact vector, and the ranks are selected
+ * there with adaptive_multiselect(). The records can be as large as needed, and they are
+ * only read once.
+ * Cost: O(n) to copy the keys, plus the cost of adaptive_multiselect()
+ * @param records Records vector
+ * @param ranks Ranks to select, sorted
+ * @param key Function returning the key of a record
+ * @return Position in records of the ranks[i]-smallest record, for every rank i
+ */
+template<class T, class Key> vector<int> argselect(const vector<T> &records,
+        const vector<int> &ranks, Key key)
+{
+    typedef typename decay<decltype(key(records[0]))>::type K;
+    
+    vector< Indexed<K> > keys(records.size());
+    
+    for(int i = 0; i < records.size(); ++i)
+    {
+        keys[i].key = key(records[i]);
+        keys[i].index = i;
+    }
+    
+    vector< Indexed<K> > selected = adaptive_multiselect(keys, ranks);
+    vector<int> positions(ranks.size());
+    
+    for(int i = 0; i < ranks.size(); ++i)
+        positions[i] = selected[i].index;
+    
+    return positions;
+}
+
+/**
+ * Solves the multiselection problem returning positions instead of elements.
+ * Shortcut of argselect() where every element is its own key.
+ * @param elements Elements vector
+ * @param ranks Ranks to select, sorted
+ * @return Position in elements of the ranks[i]-smallest element, for every rank i
+ */
+template<class T> vector<int> argselect(const vector<T> &elements, const vector<int> &ranks)
+{
+    return argselect(elements, ranks, [](const T &element) { return element; });
+}
+
 /**
  * Reads a vector from the input stream.
  * @param v Destination vector
@@ -190,11 +635,11 @@ template<class T> void read_vector(vector<T>& v)
  * Reads a vector of integers and substracts 1 to each element.
  * @param ranks Ranks destination vector
  */
-void read_ranks(vector<int>& ranks)
+template<class T> void read_ranks(vector<T>& ranks)
 {
     for(int i = 0; i < ranks.size(); ++i)
     {
-        int aux;
+        T aux;
         cin >> aux;
         
         ranks[i] = aux - 1;
@@ -219,28 +664,127 @@ template<class T> void print_vector(const vector<T>& v, const vector<T> &indexes
     cout << endl;
 }
 
+/**
+ * Prints all the elements of a vector v.
+ * @param v Vector elements to print
+ */
+template<class T> void print_vector(const vector<T>& v)
+{
+    for(int i = 0; i < v.size(); ++i)
+    {
+        if(i != 0)
+            cout << ' ';
+        
+        cout << v[i];
+    }
+    
+    cout << endl;
+}
+
+/**
+ * Solves the weighted multiselection problem:
+ *   1. Reads two integers: n, p
+ *   2. Reads a sequence of p sorted integers representing the ranks
+ *   3. Reads a sequence of n pairs of integers (value, count)
+ *   4. For every rank r in ranks, outputs the r-smallest element of the multiset where
+ *      every value appears count times
+ * @param n Number of pairs
+ * @param p Number of ranks
+ */
+void weighted_multiselect(int n, int p)
+{
+    vector< Weighted<int> > elements(n);
+    vector<long long> ranges(p);
+    vector<int> selected;
+    
+    {
+        STAT_PHASE(read);
+        
+        read_ranks(ranges);
+        read_vector(elements);
+    }
+    
+    {
+        STAT_PHASE(select);
+        selected = multiselect(elements, ranges);
+    }
+    
+    {
+        STAT_PHASE(print);
+        print_vector(selected);
+    }
+}
+
 /**
  * Solves the multiselection problem:
  *   1. Reads two integers: n, p where p <= n
  *   2. Reads a sequence of p sorted integers representing the ranks
  *   3. Reads a sequence of n integers representing the elements
  *   4. For every rank r in ranks, outputs the r-smallest element in elements
+ * 
+ * Options:
+ *   --weighted  The elements are (value, count) pairs, see weighted_multiselect()
+ *   --argselect Outputs the position (starting at 1) of the r-smallest element instead,
+ *               see argselect(). Equal elements are ranked by position.
+ * 
+ * @param argc Number of arguments
+ * @param argv Arguments
  * @return Execution status
  */
-int main()
+int main(int argc, char* argv[])
 {
+    bool weighted = false;
+    bool positions = false;
+    
+    for(int i = 1; i < argc; ++i)
+    {
+        string option = argv[i];
+        
+        if(option == "--weighted")
+            weighted = true;
+        
+        else if(option == "--argselect")
+            positions = true;
+    }
+    
     int n, p;
     cin >> n >> p;
     
+    if(weighted)
+    {
+        weighted_multiselect(n, p);
+        return 0;
+    }
+    
     vector<int> elements(n);
     vector<int> ranges(p);
+    vector<int> selected;
     
-    read_ranks(ranges);
-    read_vector(elements);
+    {
+        STAT_PHASE(read);
+        
+        read_ranks(ranges);
+        read_vector(elements);
+    }
     
-    multiselect(elements, ranges);
+    {
+        STAT_PHASE(select);
+        
+        if(positions)
+        {
+            selected = argselect(elements, ranges);
+            
+            for(int i = 0; i < p; ++i)
+                selected[i]++;
+        }
+        else
+            selected = adaptive_multiselect(elements, ranges);
+    }
     
-    print_vector(elements, ranges);
+    {
+        STAT_PHASE(print);
+        print_vector(selected);
+    }
     
     return 0;
 }
@@ -25,9 +25,14 @@ class Test
     @size = size
   end
 
+  # Elements of the test
+  def elements
+    rand_array(@size)
+  end
+
   def generate
     # Generates an array of (t+1) * SIZE_JUMP @size
-    v = rand_array(@size)
+    v = elements
     p = [ 1 ]
     
     seed = rand(48) + 2
@@ -53,13 +58,23 @@ class Test
     end
   end
 
+  # Kind of elements of the test
+  def kind
+    "elements"
+  end
+
+  # Options of the tested program
+  def options
+    ""
+  end
+
   def perform
-    print "Testing #{@size} elements... ".yellow
+    print "Testing #{@size} #{kind}#{options}... ".yellow
 
     generate
 
     beginning_time = Time.now
-    execution = system("./test < test_#{@size}.dat > test_#{@size}_exec.out")
+    execution = system("./test#{options} < test_#{@size}.dat > test_#{@size}_exec.out")
     end_time = Time.now
 
     unless execution
@@ -83,6 +98,90 @@ class Test
 
 end
 
+class NearlySortedTest < Test
+  def kind
+    "nearly sorted elements"
+  end
+
+  # Sorted runs, some of them descending, with a few elements out of place
+  def elements
+    v = rand_array(@size)
+    runs = rand(20) + 1
+
+    v = v.each_slice(@size / runs + 1).flat_map { |run| rand(2) == 0 ? run.sort : run.sort.reverse }
+
+    rand(10).times do
+      i = rand(@size)
+      j = rand(@size)
+      v[i], v[j] = v[j], v[i]
+    end
+
+    v
+  end
+end
+
+class WeightedTest < Test
+  def options
+    " --weighted"
+  end
+
+  def generate
+    # (value, count) pairs, with some big counts
+    values = rand_array(@size)
+    counts = Array.new(@size) { rand(10) == 0 ? rand(10**9) : rand(10) }
+    counts[0] += 1
+    total = counts.sum
+
+    ranks = Array.new(rand(50) + 1) { rand(total) + 1 }.sort
+
+    File.open("test_#{@size}.dat", "w") do |f|
+      pairs = values.zip(counts).map { |pair| pair.join(" ") }
+      f.write("#{@size} #{ranks.size} #{ranks.join(" ")} #{pairs.join(" ")}")
+    end
+
+    # Walk the sorted pairs accumulating counts
+    sorted = values.zip(counts).sort
+    selected = []
+    weight = 0
+    i = -1
+
+    ranks.each do |r|
+      weight += sorted[i += 1][1] while weight < r
+      selected << sorted[i][0]
+    end
+
+    File.open("test_#{@size}.out", "w") do |f|
+      f.write("#{selected.join(" ")}\n")
+    end
+  end
+end
+
+class ArgselectTest < Test
+  def kind
+    "elements with repetitions"
+  end
+
+  def options
+    " --argselect"
+  end
+
+  def generate
+    v = rand_array(@size, @size / 4 + 1)
+    p = Array.new(rand(50) + 1) { rand(@size) + 1 }.uniq.sort
+
+    File.open("test_#{@size}.dat", "w") do |f|
+      f.write("#{@size} #{p.size} #{p.join(" ")} #{v.join(" ")}")
+    end
+
+    # Positions sorted by element, and equal elements by position
+    positions = (1..@size).sort_by { |i| [ v[i-1], i ] }
+
+    File.open("test_#{@size}.out", "w") do |f|
+      f.write("#{p.map { |i| positions[i-1] }.join(" ")}\n")
+    end
+  end
+end
+
 puts "Compiling main.cc...".blue
 compiled = system("g++ main.cc -o test -O2")
 
@@ -95,6 +194,9 @@ SAMPLES.times do |t|
   size = (t+1) * SIZE_JUMP
   test = Test.new(size)
   test.perform
+  NearlySortedTest.new(size).perform
+  WeightedTest.new(size).perform
+  ArgselectTest.new(size).perform
 end
 
 File.delete("test")
@@ -0,0 +1,180 @@
+require 'fileutils'
+require 'colorize'
+require 'json'
+
+# Number of words of the random paragraphs
+SIZES = [ 5000, 20000 ]
+
+# Sets of target widths arranged in a single pass
+TARGETS = [ [ 40, 60 ], [ 20, 40, 60, 80 ], [ 20, 30, 40, 50, 60, 70, 80, 90 ] ]
+
+# Runs of every measure, the fastest one is reported
+REPEAT = 3
+
+# Megabytes of prose of the tokenizer benchmark
+PROSE_MB = 20
+
+# Paragraph sizes and number of edits of the edit benchmark
+EDIT_SIZES = [ 10000, 100000 ]
+EDITS = 100
+
+# Generates a random paragraph of size words, written in lines of 15 words
+def rand_paragraph(size)
+  words = Array.new(size) { Array.new(rand(12) + 1) { ("a".."h").to_a.sample }.join }
+
+  words.each_slice(15).map { |line| line.join(" ") }.join("\n") + "\n"
+end
+
+# Generates about megabytes of random ASCII prose, with words of 1 to 12 letters (most of
+# them shorter than 8) in lines of 15 words and a blank line every 100 lines
+def rand_prose(megabytes)
+  dictionary = Array.new(5000) { Array.new(rand(12) + 1) { ("a".."z").to_a.sample }.join }
+  dictionary += Array.new(5000) { Array.new(rand(5) + 1) { ("a".."z").to_a.sample }.join }
+
+  lines = Array.new(megabytes * 10**6 / 90) do |i|
+    line = Array.new(15) { dictionary.sample }.join(" ")
+    i % 100 == 99 ? line + "\n" : line
+  end
+
+  lines.join("\n") + "\n"
+end
+
+# Compares the time to read (tokenize) the same input with the SWAR scanner and with the
+# scalar one (make scalar), which scans every byte alone
+def bench_tokenizer
+  puts "Tokenizing #{PROSE_MB} MB of prose...".yellow
+
+  File.open("bench.dat", "w") { |f| f.write("60\n#{rand_prose(PROSE_MB)}") }
+
+  times = [ "instrument", "scalar" ].map do |binary|
+    REPEAT.times.map do
+      stats = `./#{binary} < bench.dat 2>&1 > bench_#{binary}.out`
+
+      unless $?.success?
+        puts "Failed".red
+        exit(1)
+      end
+
+      JSON.parse(stats.lines.last)["read_ms"]
+    end.min
+  end
+
+  unless FileUtils.cmp("bench_instrument.out", "bench_scalar.out")
+    puts "Wrong".red
+    exit(1)
+  end
+
+  puts "  SWAR #{times[0].round(1)} ms, scalar #{times[1].round(1)} ms"
+  puts "  SWAR #{(times[1] / times[0]).round(2)}x faster".blue
+
+  File.delete("bench.dat", "bench_instrument.out", "bench_scalar.out")
+end
+
+# Measures the time of EDITS nearby edits (like typing) close to the start of paragraphs
+# of EDIT_SIZES words. Every edit only recomputes the affected region and moves the gap
+# from the previous one, so the time per edit should not grow with the paragraph.
+def bench_edits
+  EDIT_SIZES.each do |size|
+    puts "Editing #{size} words #{EDITS} times...".yellow
+
+    edits = []
+    position = 10
+
+    EDITS.times do |i|
+      position = [ [ position + rand(5) - 2, 1 ].max, 50 ].min
+      word = Array.new(rand(6) + 1) { ("a".."h").to_a.sample }.join
+
+      edits << [ "+ #{position} #{word}", "= #{position} #{word}", "- #{position}" ][i % 3]
+    end
+
+    File.open("bench.dat", "w") { |f| f.write("60\n#{rand_paragraph(size)}\n#{edits.join("\n")}\n") }
+
+    time = REPEAT.times.map do
+      stats = `./instrument --edit --threads 2 < bench.dat 2>&1 > /dev/null`
+
+      unless $?.success?
+        puts "Failed".red
+        exit(1)
+      end
+
+      JSON.parse(stats.lines.last)["edit_ms"]
+    end.min
+
+    puts "  #{(time * 1000 / EDITS).round(1)} us per edit".blue
+
+    File.delete("bench.dat")
+  end
+end
+
+class Bench
+  def initialize(size, widths)
+    @size = size
+    @widths = widths
+  end
+
+  # Runs the formatter with the given header line, returning its output and the fastest
+  # wall time of REPEAT runs, in milliseconds
+  def run(header)
+    File.open("bench.dat", "w") { |f| f.write("#{header}\n#{@paragraph}") }
+
+    best = nil
+    output = nil
+
+    REPEAT.times do
+      start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      output = `./test < bench.dat`
+      elapsed = (Process.clock_gettime(Process::CLOCK_MONOTONIC) - start) * 1000
+
+      unless $?.success?
+        puts "Failed".red
+        exit(1)
+      end
+
+      best = [ best, elapsed ].compact.min
+    end
+
+    File.delete("bench.dat")
+    [ output, best ]
+  end
+
+  def perform
+    puts "Arranging #{@size} words for widths #{@widths.join(" ")}...".yellow
+
+    @paragraph = rand_paragraph(@size)
+
+    multi, multi_ms = run(@widths.join(" "))
+
+    singles = @widths.map { |width| run(width.to_s) }
+    separate_ms = singles.map(&:last).sum
+
+    # Same arrangements as the separate runs, each one preceded by its width
+    expected = @widths.zip(singles).map { |width, (output, _)| "Width: #{width}\n#{output}" }
+
+    unless multi == expected.join("\n")
+      puts "Wrong".red
+      exit(1)
+    end
+
+    puts "  single pass #{multi_ms.round(1)} ms, #{@widths.size} separate runs #{separate_ms.round(1)} ms"
+    puts "  Single pass #{(separate_ms / multi_ms).round(2)}x faster".blue
+  end
+end
+
+puts "Compiling main.cc...".blue
+compiled = system("make -s -B test instrument scalar")
+
+unless compiled
+  puts "Compilation failed.".red
+  exit(1)
+end
+
+SIZES.each do |size|
+  TARGETS.each do |widths|
+    Bench.new(size, widths).perform
+  end
+end
+
+bench_tokenizer
+bench_edits
+
+File.delete("test", "instrument", "scalar")
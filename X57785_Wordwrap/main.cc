@@ -1,15 +1,579 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <deque>
+#include <algorithm>
 #include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <climits>
+#include <thread>
+
+// The AVX2 kernels are compiled for x86 with the target attribute and they are only used
+// when the processor supports them, so the binary stays portable
+#if defined(__x86_64__) or defined(__i386__)
+#include <immintrin.h>
+#define AVX2_KERNELS
+#endif
 
 using namespace std;
 
+#ifdef INSTRUMENT
+#include <atomic>
+#include <chrono>
+
+/**
+ * Counters of the formatter, written as JSON to the standard error when the program exits.
+ * Only compiled with -DINSTRUMENT (make instrument); otherwise the STAT_* macros expand to
+ * nothing. Counters are atomic because the parallel wordwrap updates them from several
+ * threads.
+ */
+struct Statistics
+{
+    atomic<long long> paragraphs, words, candidates, edits, recomputed;
+    double read_ms, wordwrap_ms, edit_ms, print_ms;
+    
+    ~Statistics()
+    {
+        fprintf(stderr, "{\"paragraphs\": %lld, \"words\": %lld, \"candidates\": %lld, "
+                "\"edits\": %lld, \"recomputed\": %lld, \"read_ms\": %.3f, "
+                "\"wordwrap_ms\": %.3f, \"edit_ms\": %.3f, \"print_ms\": %.3f}\n",
+                paragraphs.load(), words.load(), candidates.load(), edits.load(),
+                recomputed.load(), read_ms, wordwrap_ms, edit_ms, print_ms);
+    }
+} statistics;
+
+/**
+ * Adds the time elapsed during its lifetime to a phase of the statistics.
+ */
+struct PhaseTimer
+{
+    double &total;
+    chrono::steady_clock::time_point start;
+    
+    PhaseTimer(double &total) : total(total), start(chrono::steady_clock::now())
+    { }
+    
+    ~PhaseTimer()
+    {
+        total += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+};
+
+#define STAT_ADD(counter, value) (statistics.counter += (value))
+#define STAT_PHASE(phase) PhaseTimer phase##_timer(statistics.phase##_ms)
+#else
+#define STAT_ADD(counter, value) ((void) 0)
+#define STAT_PHASE(phase)
+#endif
+
+/**
+ * Tells whether a byte is a word separator.
+ * Same separators as the ones skipped by the stream extraction operator.
+ * @param c A byte
+ * @return True if c is a space, a tab, a line break or a carriage return
+ */
+inline bool isSeparator(unsigned char c)
+{
+    return c == ' ' or (c >= '\t' and c <= '\r');
+}
+
+/**
+ * Codepoints that take no columns, sorted: nonspacing marks (general category Mn),
+ * enclosing marks (Me) and format characters (Cf), except the soft hyphen U+00AD and the
+ * prepended concatenation marks (like U+0600), which are visible, and the Hangul Jamo
+ * medial vowels and final consonants (U+1160..U+11FF, U+D7B0..U+D7FF), which combine
+ * with the previous Jamo into one syllable.
+ * Generated from the Unicode Character Database 14.0.0.
+ */
+const uint32_t ZERO_WIDTH[][2] =
+{
+    { 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD }, { 0x05BF, 0x05BF },
+    { 0x05C1, 0x05C2 }, { 0x05C4, 0x05C5 }, { 0x05C7, 0x05C7 }, { 0x0610, 0x061A },
+    { 0x061C, 0x061C }, { 0x064B, 0x065F }, { 0x0670, 0x0670 }, { 0x06D6, 0x06DC },
+    { 0x06DF, 0x06E4 }, { 0x06E7, 0x06E8 }, { 0x06EA, 0x06ED }, { 0x0711, 0x0711 },
+    { 0x0730, 0x074A }, { 0x07A6, 0x07B0 }, { 0x07EB, 0x07F3 }, { 0x07FD, 0x07FD },
+    { 0x0816, 0x0819 }, { 0x081B, 0x0823 }, { 0x0825, 0x0827 }, { 0x0829, 0x082D },
+    { 0x0859, 0x085B }, { 0x0898, 0x089F }, { 0x08CA, 0x08E1 }, { 0x08E3, 0x0902 },
+    { 0x093A, 0x093A }, { 0x093C, 0x093C }, { 0x0941, 0x0948 }, { 0x094D, 0x094D },
+    { 0x0951, 0x0957 }, { 0x0962, 0x0963 }, { 0x0981, 0x0981 }, { 0x09BC, 0x09BC },
+    { 0x09C1, 0x09C4 }, { 0x09CD, 0x09CD }, { 0x09E2, 0x09E3 }, { 0x09FE, 0x09FE },
+    { 0x0A01, 0x0A02 }, { 0x0A3C, 0x0A3C }, { 0x0A41, 0x0A42 }, { 0x0A47, 0x0A48 },
+    { 0x0A4B, 0x0A4D }, { 0x0A51, 0x0A51 }, { 0x0A70, 0x0A71 }, { 0x0A75, 0x0A75 },
+    { 0x0A81, 0x0A82 }, { 0x0ABC, 0x0ABC }, { 0x0AC1, 0x0AC5 }, { 0x0AC7, 0x0AC8 },
+    { 0x0ACD, 0x0ACD }, { 0x0AE2, 0x0AE3 }, { 0x0AFA, 0x0AFF }, { 0x0B01, 0x0B01 },
+    { 0x0B3C, 0x0B3C }, { 0x0B3F, 0x0B3F }, { 0x0B41, 0x0B44 }, { 0x0B4D, 0x0B4D },
+    { 0x0B55, 0x0B56 }, { 0x0B62, 0x0B63 }, { 0x0B82, 0x0B82 }, { 0x0BC0, 0x0BC0 },
+    { 0x0BCD, 0x0BCD }, { 0x0C00, 0x0C00 }, { 0x0C04, 0x0C04 }, { 0x0C3C, 0x0C3C },
+    { 0x0C3E, 0x0C40 }, { 0x0C46, 0x0C48 }, { 0x0C4A, 0x0C4D }, { 0x0C55, 0x0C56 },
+    { 0x0C62, 0x0C63 }, { 0x0C81, 0x0C81 }, { 0x0CBC, 0x0CBC }, { 0x0CBF, 0x0CBF },
+    { 0x0CC6, 0x0CC6 }, { 0x0CCC, 0x0CCD }, { 0x0CE2, 0x0CE3 }, { 0x0D00, 0x0D01 },
+    { 0x0D3B, 0x0D3C }, { 0x0D41, 0x0D44 }, { 0x0D4D, 0x0D4D }, { 0x0D62, 0x0D63 },
+    { 0x0D81, 0x0D81 }, { 0x0DCA, 0x0DCA }, { 0x0DD2, 0x0DD4 }, { 0x0DD6, 0x0DD6 },
+    { 0x0E31, 0x0E31 }, { 0x0E34, 0x0E3A }, { 0x0E47, 0x0E4E }, { 0x0EB1, 0x0EB1 },
+    { 0x0EB4, 0x0EBC }, { 0x0EC8, 0x0ECD }, { 0x0F18, 0x0F19 }, { 0x0F35, 0x0F35 },
+    { 0x0F37, 0x0F37 }, { 0x0F39, 0x0F39 }, { 0x0F71, 0x0F7E }, { 0x0F80, 0x0F84 },
+    { 0x0F86, 0x0F87 }, { 0x0F8D, 0x0F97 }, { 0x0F99, 0x0FBC }, { 0x0FC6, 0x0FC6 },
+    { 0x102D, 0x1030 }, { 0x1032, 0x1037 }, { 0x1039, 0x103A }, { 0x103D, 0x103E },
+    { 0x1058, 0x1059 }, { 0x105E, 0x1060 }, { 0x1071, 0x1074 }, { 0x1082, 0x1082 },
+    { 0x1085, 0x1086 }, { 0x108D, 0x108D }, { 0x109D, 0x109D }, { 0x1160, 0x11FF },
+    { 0x135D, 0x135F }, { 0x1712, 0x1714 }, { 0x1732, 0x1733 }, { 0x1752, 0x1753 },
+    { 0x1772, 0x1773 }, { 0x17B4, 0x17B5 }, { 0x17B7, 0x17BD }, { 0x17C6, 0x17C6 },
+    { 0x17C9, 0x17D3 }, { 0x17DD, 0x17DD }, { 0x180B, 0x180F }, { 0x1885, 0x1886 },
+    { 0x18A9, 0x18A9 }, { 0x1920, 0x1922 }, { 0x1927, 0x1928 }, { 0x1932, 0x1932 },
+    { 0x1939, 0x193B }, { 0x1A17, 0x1A18 }, { 0x1A1B, 0x1A1B }, { 0x1A56, 0x1A56 },
+    { 0x1A58, 0x1A5E }, { 0x1A60, 0x1A60 }, { 0x1A62, 0x1A62 }, { 0x1A65, 0x1A6C },
+    { 0x1A73, 0x1A7C }, { 0x1A7F, 0x1A7F }, { 0x1AB0, 0x1ACE }, { 0x1B00, 0x1B03 },
+    { 0x1B34, 0x1B34 }, { 0x1B36, 0x1B3A }, { 0x1B3C, 0x1B3C }, { 0x1B42, 0x1B42 },
+    { 0x1B6B, 0x1B73 }, { 0x1B80, 0x1B81 }, { 0x1BA2, 0x1BA5 }, { 0x1BA8, 0x1BA9 },
+    { 0x1BAB, 0x1BAD }, { 0x1BE6, 0x1BE6 }, { 0x1BE8, 0x1BE9 }, { 0x1BED, 0x1BED },
+    { 0x1BEF, 0x1BF1 }, { 0x1C2C, 0x1C33 }, { 0x1C36, 0x1C37 }, { 0x1CD0, 0x1CD2 },
+    { 0x1CD4, 0x1CE0 }, { 0x1CE2, 0x1CE8 }, { 0x1CED, 0x1CED }, { 0x1CF4, 0x1CF4 },
+    { 0x1CF8, 0x1CF9 }, { 0x1DC0, 0x1DFF }, { 0x200B, 0x200F }, { 0x202A, 0x202E },
+    { 0x2060, 0x2064 }, { 0x2066, 0x206F }, { 0x20D0, 0x20F0 }, { 0x2CEF, 0x2CF1 },
+    { 0x2D7F, 0x2D7F }, { 0x2DE0, 0x2DFF }, { 0x302A, 0x302D }, { 0x3099, 0x309A },
+    { 0xA66F, 0xA672 }, { 0xA674, 0xA67D }, { 0xA69E, 0xA69F }, { 0xA6F0, 0xA6F1 },
+    { 0xA802, 0xA802 }, { 0xA806, 0xA806 }, { 0xA80B, 0xA80B }, { 0xA825, 0xA826 },
+    { 0xA82C, 0xA82C }, { 0xA8C4, 0xA8C5 }, { 0xA8E0, 0xA8F1 }, { 0xA8FF, 0xA8FF },
+    { 0xA926, 0xA92D }, { 0xA947, 0xA951 }, { 0xA980, 0xA982 }, { 0xA9B3, 0xA9B3 },
+    { 0xA9B6, 0xA9B9 }, { 0xA9BC, 0xA9BD }, { 0xA9E5, 0xA9E5 }, { 0xAA29, 0xAA2E },
+    { 0xAA31, 0xAA32 }, { 0xAA35, 0xAA36 }, { 0xAA43, 0xAA43 }, { 0xAA4C, 0xAA4C },
+    { 0xAA7C, 0xAA7C }, { 0xAAB0, 0xAAB0 }, { 0xAAB2, 0xAAB4 }, { 0xAAB7, 0xAAB8 },
+    { 0xAABE, 0xAABF }, { 0xAAC1, 0xAAC1 }, { 0xAAEC, 0xAAED }, { 0xAAF6, 0xAAF6 },
+    { 0xABE5, 0xABE5 }, { 0xABE8, 0xABE8 }, { 0xABED, 0xABED }, { 0xD7B0, 0xD7FF },
+    { 0xFB1E, 0xFB1E }, { 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F }, { 0xFEFF, 0xFEFF },
+    { 0xFFF9, 0xFFFB }, { 0x101FD, 0x101FD }, { 0x102E0, 0x102E0 }, { 0x10376, 0x1037A },
+    { 0x10A01, 0x10A03 }, { 0x10A05, 0x10A06 }, { 0x10A0C, 0x10A0F }, { 0x10A38, 0x10A3A },
+    { 0x10A3F, 0x10A3F }, { 0x10AE5, 0x10AE6 }, { 0x10D24, 0x10D27 }, { 0x10EAB, 0x10EAC },
+    { 0x10F46, 0x10F50 }, { 0x10F82, 0x10F85 }, { 0x11001, 0x11001 }, { 0x11038, 0x11046 },
+    { 0x11070, 0x11070 }, { 0x11073, 0x11074 }, { 0x1107F, 0x11081 }, { 0x110B3, 0x110B6 },
+    { 0x110B9, 0x110BA }, { 0x110C2, 0x110C2 }, { 0x11100, 0x11102 }, { 0x11127, 0x1112B },
+    { 0x1112D, 0x11134 }, { 0x11173, 0x11173 }, { 0x11180, 0x11181 }, { 0x111B6, 0x111BE },
+    { 0x111C9, 0x111CC }, { 0x111CF, 0x111CF }, { 0x1122F, 0x11231 }, { 0x11234, 0x11234 },
+    { 0x11236, 0x11237 }, { 0x1123E, 0x1123E }, { 0x112DF, 0x112DF }, { 0x112E3, 0x112EA },
+    { 0x11300, 0x11301 }, { 0x1133B, 0x1133C }, { 0x11340, 0x11340 }, { 0x11366, 0x1136C },
+    { 0x11370, 0x11374 }, { 0x11438, 0x1143F }, { 0x11442, 0x11444 }, { 0x11446, 0x11446 },
+    { 0x1145E, 0x1145E }, { 0x114B3, 0x114B8 }, { 0x114BA, 0x114BA }, { 0x114BF, 0x114C0 },
+    { 0x114C2, 0x114C3 }, { 0x115B2, 0x115B5 }, { 0x115BC, 0x115BD }, { 0x115BF, 0x115C0 },
+    { 0x115DC, 0x115DD }, { 0x11633, 0x1163A }, { 0x1163D, 0x1163D }, { 0x1163F, 0x11640 },
+    { 0x116AB, 0x116AB }, { 0x116AD, 0x116AD }, { 0x116B0, 0x116B5 }, { 0x116B7, 0x116B7 },
+    { 0x1171D, 0x1171F }, { 0x11722, 0x11725 }, { 0x11727, 0x1172B }, { 0x1182F, 0x11837 },
+    { 0x11839, 0x1183A }, { 0x1193B, 0x1193C }, { 0x1193E, 0x1193E }, { 0x11943, 0x11943 },
+    { 0x119D4, 0x119D7 }, { 0x119DA, 0x119DB }, { 0x119E0, 0x119E0 }, { 0x11A01, 0x11A0A },
+    { 0x11A33, 0x11A38 }, { 0x11A3B, 0x11A3E }, { 0x11A47, 0x11A47 }, { 0x11A51, 0x11A56 },
+    { 0x11A59, 0x11A5B }, { 0x11A8A, 0x11A96 }, { 0x11A98, 0x11A99 }, { 0x11C30, 0x11C36 },
+    { 0x11C38, 0x11C3D }, { 0x11C3F, 0x11C3F }, { 0x11C92, 0x11CA7 }, { 0x11CAA, 0x11CB0 },
+    { 0x11CB2, 0x11CB3 }, { 0x11CB5, 0x11CB6 }, { 0x11D31, 0x11D36 }, { 0x11D3A, 0x11D3A },
+    { 0x11D3C, 0x11D3D }, { 0x11D3F, 0x11D45 }, { 0x11D47, 0x11D47 }, { 0x11D90, 0x11D91 },
+    { 0x11D95, 0x11D95 }, { 0x11D97, 0x11D97 }, { 0x11EF3, 0x11EF4 }, { 0x13430, 0x13438 },
+    { 0x16AF0, 0x16AF4 }, { 0x16B30, 0x16B36 }, { 0x16F4F, 0x16F4F }, { 0x16F8F, 0x16F92 },
+    { 0x16FE4, 0x16FE4 }, { 0x1BC9D, 0x1BC9E }, { 0x1BCA0, 0x1BCA3 }, { 0x1CF00, 0x1CF2D },
+    { 0x1CF30, 0x1CF46 }, { 0x1D167, 0x1D169 }, { 0x1D173, 0x1D182 }, { 0x1D185, 0x1D18B },
+    { 0x1D1AA, 0x1D1AD }, { 0x1D242, 0x1D244 }, { 0x1DA00, 0x1DA36 }, { 0x1DA3B, 0x1DA6C },
+    { 0x1DA75, 0x1DA75 }, { 0x1DA84, 0x1DA84 }, { 0x1DA9B, 0x1DA9F }, { 0x1DAA1, 0x1DAAF },
+    { 0x1E000, 0x1E006 }, { 0x1E008, 0x1E018 }, { 0x1E01B, 0x1E021 }, { 0x1E023, 0x1E024 },
+    { 0x1E026, 0x1E02A }, { 0x1E130, 0x1E136 }, { 0x1E2AE, 0x1E2AE }, { 0x1E2EC, 0x1E2EF },
+    { 0x1E8D0, 0x1E8D6 }, { 0x1E944, 0x1E94A }, { 0xE0001, 0xE0001 }, { 0xE0020, 0xE007F },
+    { 0xE0100, 0xE01EF }
+};
+
+/**
+ * Codepoints that take two columns, sorted: East Asian Wide (W) and Fullwidth (F)
+ * characters, including emoji, and the planes 2 and 3. Unassigned codepoints between two
+ * ranges are merged into them.
+ * Generated from the Unicode Character Database 14.0.0.
+ */
+const uint32_t DOUBLE_WIDTH[][2] =
+{
+    { 0x0378, 0x0379 }, { 0x0380, 0x0383 }, { 0x038B, 0x038B }, { 0x038D, 0x038D },
+    { 0x03A2, 0x03A2 }, { 0x0530, 0x0530 }, { 0x0557, 0x0558 }, { 0x058B, 0x058C },
+    { 0x0590, 0x0590 }, { 0x05C8, 0x05CF }, { 0x05EB, 0x05EE }, { 0x05F5, 0x05FF },
+    { 0x070E, 0x070E }, { 0x074B, 0x074C }, { 0x07B2, 0x07BF }, { 0x07FB, 0x07FC },
+    { 0x082E, 0x082F }, { 0x083F, 0x083F }, { 0x085C, 0x085D }, { 0x085F, 0x085F },
+    { 0x086B, 0x086F }, { 0x088F, 0x088F }, { 0x0892, 0x0897 }, { 0x0984, 0x0984 },
+    { 0x098D, 0x098E }, { 0x0991, 0x0992 }, { 0x09A9, 0x09A9 }, { 0x09B1, 0x09B1 },
+    { 0x09B3, 0x09B5 }, { 0x09BA, 0x09BB }, { 0x09C5, 0x09C6 }, { 0x09C9, 0x09CA },
+    { 0x09CF, 0x09D6 }, { 0x09D8, 0x09DB }, { 0x09DE, 0x09DE }, { 0x09E4, 0x09E5 },
+    { 0x09FF, 0x0A00 }, { 0x0A04, 0x0A04 }, { 0x0A0B, 0x0A0E }, { 0x0A11, 0x0A12 },
+    { 0x0A29, 0x0A29 }, { 0x0A31, 0x0A31 }, { 0x0A34, 0x0A34 }, { 0x0A37, 0x0A37 },
+    { 0x0A3A, 0x0A3D }, { 0x0A43, 0x0A58 }, { 0x0A5D, 0x0A5D }, { 0x0A5F, 0x0A65 },
+    { 0x0A77, 0x0A80 }, { 0x0A84, 0x0A84 }, { 0x0A8E, 0x0A8E }, { 0x0A92, 0x0A92 },
+    { 0x0AA9, 0x0AA9 }, { 0x0AB1, 0x0AB1 }, { 0x0AB4, 0x0AB4 }, { 0x0ABA, 0x0ABB },
+    { 0x0AC6, 0x0AC6 }, { 0x0ACA, 0x0ACA }, { 0x0ACE, 0x0ACF }, { 0x0AD1, 0x0ADF },
+    { 0x0AE4, 0x0AE5 }, { 0x0AF2, 0x0AF8 }, { 0x0B00, 0x0B00 }, { 0x0B04, 0x0B04 },
+    { 0x0B0D, 0x0B0E }, { 0x0B11, 0x0B12 }, { 0x0B29, 0x0B29 }, { 0x0B31, 0x0B31 },
+    { 0x0B34, 0x0B34 }, { 0x0B3A, 0x0B3B }, { 0x0B45, 0x0B46 }, { 0x0B49, 0x0B4A },
+    { 0x0B4E, 0x0B54 }, { 0x0B58, 0x0B5B }, { 0x0B5E, 0x0B5E }, { 0x0B64, 0x0B65 },
+    { 0x0B78, 0x0B81 }, { 0x0B84, 0x0B84 }, { 0x0B8B, 0x0B8D }, { 0x0B91, 0x0B91 },
+    { 0x0B96, 0x0B98 }, { 0x0B9B, 0x0B9B }, { 0x0B9D, 0x0B9D }, { 0x0BA0, 0x0BA2 },
+    { 0x0BA5, 0x0BA7 }, { 0x0BAB, 0x0BAD }, { 0x0BBA, 0x0BBD }, { 0x0BC3, 0x0BC5 },
+    { 0x0BC9, 0x0BC9 }, { 0x0BCE, 0x0BCF }, { 0x0BD1, 0x0BD6 }, { 0x0BD8, 0x0BE5 },
+    { 0x0BFB, 0x0BFF }, { 0x0C0D, 0x0C0D }, { 0x0C11, 0x0C11 }, { 0x0C29, 0x0C29 },
+    { 0x0C3A, 0x0C3B }, { 0x0C45, 0x0C57 }, { 0x0C5B, 0x0C5C }, { 0x0C5E, 0x0C5F },
+    { 0x0C64, 0x0C65 }, { 0x0C70, 0x0C76 }, { 0x0C8D, 0x0C8D }, { 0x0C91, 0x0C91 },
+    { 0x0CA9, 0x0CA9 }, { 0x0CB4, 0x0CB4 }, { 0x0CBA, 0x0CBB }, { 0x0CC5, 0x0CC5 },
+    { 0x0CC9, 0x0CC9 }, { 0x0CCE, 0x0CD4 }, { 0x0CD7, 0x0CDC }, { 0x0CDF, 0x0CDF },
+    { 0x0CE4, 0x0CE5 }, { 0x0CF0, 0x0CF0 }, { 0x0CF3, 0x0CFF }, { 0x0D0D, 0x0D0D },
+    { 0x0D11, 0x0D11 }, { 0x0D45, 0x0D45 }, { 0x0D49, 0x0D49 }, { 0x0D50, 0x0D53 },
+    { 0x0D64, 0x0D65 }, { 0x0D80, 0x0D80 }, { 0x0D84, 0x0D84 }, { 0x0D97, 0x0D99 },
+    { 0x0DB2, 0x0DB2 }, { 0x0DBC, 0x0DBC }, { 0x0DBE, 0x0DBF }, { 0x0DC7, 0x0DCE },
+    { 0x0DD5, 0x0DD7 }, { 0x0DE0, 0x0DE5 }, { 0x0DF0, 0x0DF1 }, { 0x0DF5, 0x0E00 },
+    { 0x0E3B, 0x0E3E }, { 0x0E5C, 0x0E80 }, { 0x0E83, 0x0E83 }, { 0x0E85, 0x0E85 },
+    { 0x0E8B, 0x0E8B }, { 0x0EA4, 0x0EA4 }, { 0x0EA6, 0x0EA6 }, { 0x0EBE, 0x0EBF },
+    { 0x0EC5, 0x0EC5 }, { 0x0EC7, 0x0ECF }, { 0x0EDA, 0x0EDB }, { 0x0EE0, 0x0EFF },
+    { 0x0F48, 0x0F48 }, { 0x0F6D, 0x0F70 }, { 0x0F98, 0x0FBD }, { 0x0FCD, 0x0FCD },
+    { 0x0FDB, 0x0FFF }, { 0x10C6, 0x10C6 }, { 0x10C8, 0x10CC }, { 0x10CE, 0x10CF },
+    { 0x1100, 0x115F }, { 0x1249, 0x1249 }, { 0x124E, 0x124F }, { 0x1257, 0x1257 },
+    { 0x1259, 0x1259 }, { 0x125E, 0x125F }, { 0x1289, 0x1289 }, { 0x128E, 0x128F },
+    { 0x12B1, 0x12B1 }, { 0x12B6, 0x12B7 }, { 0x12BF, 0x12BF }, { 0x12C1, 0x12C1 },
+    { 0x12C6, 0x12C7 }, { 0x12D7, 0x12D7 }, { 0x1311, 0x1311 }, { 0x1316, 0x1317 },
+    { 0x135B, 0x135C }, { 0x137D, 0x137F }, { 0x139A, 0x139F }, { 0x13F6, 0x13F7 },
+    { 0x13FE, 0x13FF }, { 0x169D, 0x169F }, { 0x16F9, 0x16FF }, { 0x1716, 0x171E },
+    { 0x1737, 0x173F }, { 0x1754, 0x175F }, { 0x176D, 0x176D }, { 0x1771, 0x177F },
+    { 0x17DE, 0x17DF }, { 0x17EA, 0x17EF }, { 0x17FA, 0x17FF }, { 0x181A, 0x181F },
+    { 0x1879, 0x187F }, { 0x18AB, 0x18AF }, { 0x18F6, 0x18FF }, { 0x191F, 0x191F },
+    { 0x192C, 0x192F }, { 0x193C, 0x193F }, { 0x1941, 0x1943 }, { 0x196E, 0x196F },
+    { 0x1975, 0x197F }, { 0x19AC, 0x19AF }, { 0x19CA, 0x19CF }, { 0x19DB, 0x19DD },
+    { 0x1A1C, 0x1A1D }, { 0x1A5F, 0x1A5F }, { 0x1A7D, 0x1A7E }, { 0x1A8A, 0x1A8F },
+    { 0x1A9A, 0x1A9F }, { 0x1AAE, 0x1AFF }, { 0x1B4D, 0x1B4F }, { 0x1B7F, 0x1B7F },
+    { 0x1BF4, 0x1BFB }, { 0x1C38, 0x1C3A }, { 0x1C4A, 0x1C4C }, { 0x1C89, 0x1C8F },
+    { 0x1CBB, 0x1CBC }, { 0x1CC8, 0x1CCF }, { 0x1CFB, 0x1CFF }, { 0x1F16, 0x1F17 },
+    { 0x1F1E, 0x1F1F }, { 0x1F46, 0x1F47 }, { 0x1F4E, 0x1F4F }, { 0x1F58, 0x1F58 },
+    { 0x1F5A, 0x1F5A }, { 0x1F5C, 0x1F5C }, { 0x1F5E, 0x1F5E }, { 0x1F7E, 0x1F7F },
+    { 0x1FB5, 0x1FB5 }, { 0x1FC5, 0x1FC5 }, { 0x1FD4, 0x1FD5 }, { 0x1FDC, 0x1FDC },
+    { 0x1FF0, 0x1FF1 }, { 0x1FF5, 0x1FF5 }, { 0x1FFF, 0x1FFF }, { 0x2065, 0x2065 },
+    { 0x2072, 0x2073 }, { 0x208F, 0x208F }, { 0x209D, 0x209F }, { 0x20C1, 0x20FF },
+    { 0x218C, 0x218F }, { 0x231A, 0x231B }, { 0x2329, 0x232A }, { 0x23E9, 0x23EC },
+    { 0x23F0, 0x23F0 }, { 0x23F3, 0x23F3 }, { 0x2427, 0x243F }, { 0x244B, 0x245F },
+    { 0x25FD, 0x25FE }, { 0x2614, 0x2615 }, { 0x2648, 0x2653 }, { 0x267F, 0x267F },
+    { 0x2693, 0x2693 }, { 0x26A1, 0x26A1 }, { 0x26AA, 0x26AB }, { 0x26BD, 0x26BE },
+    { 0x26C4, 0x26C5 }, { 0x26CE, 0x26CE }, { 0x26D4, 0x26D4 }, { 0x26EA, 0x26EA },
+    { 0x26F2, 0x26F3 }, { 0x26F5, 0x26F5 }, { 0x26FA, 0x26FA }, { 0x26FD, 0x26FD },
+    { 0x2705, 0x2705 }, { 0x270A, 0x270B }, { 0x2728, 0x2728 }, { 0x274C, 0x274C },
+    { 0x274E, 0x274E }, { 0x2753, 0x2755 }, { 0x2757, 0x2757 }, { 0x2795, 0x2797 },
+    { 0x27B0, 0x27B0 }, { 0x27BF, 0x27BF }, { 0x2B1B, 0x2B1C }, { 0x2B50, 0x2B50 },
+    { 0x2B55, 0x2B55 }, { 0x2B74, 0x2B75 }, { 0x2B96, 0x2B96 }, { 0x2CF4, 0x2CF8 },
+    { 0x2D26, 0x2D26 }, { 0x2D28, 0x2D2C }, { 0x2D2E, 0x2D2F }, { 0x2D68, 0x2D6E },
+    { 0x2D71, 0x2D7E }, { 0x2D97, 0x2D9F }, { 0x2DA7, 0x2DA7 }, { 0x2DAF, 0x2DAF },
+    { 0x2DB7, 0x2DB7 }, { 0x2DBF, 0x2DBF }, { 0x2DC7, 0x2DC7 }, { 0x2DCF, 0x2DCF },
+    { 0x2DD7, 0x2DD7 }, { 0x2DDF, 0x2DDF }, { 0x2E5E, 0x303E }, { 0x3040, 0x3247 },
+    { 0x3250, 0x4DBF }, { 0x4E00, 0xA4CF }, { 0xA62C, 0xA63F }, { 0xA6F8, 0xA6FF },
+    { 0xA7CB, 0xA7CF }, { 0xA7D2, 0xA7D2 }, { 0xA7D4, 0xA7D4 }, { 0xA7DA, 0xA7F1 },
+    { 0xA82D, 0xA82F }, { 0xA83A, 0xA83F }, { 0xA878, 0xA87F }, { 0xA8C6, 0xA8CD },
+    { 0xA8DA, 0xA8DF }, { 0xA954, 0xA95E }, { 0xA960, 0xA97F }, { 0xA9CE, 0xA9CE },
+    { 0xA9DA, 0xA9DD }, { 0xA9FF, 0xA9FF }, { 0xAA37, 0xAA3F }, { 0xAA4E, 0xAA4F },
+    { 0xAA5A, 0xAA5B }, { 0xAAC3, 0xAADA }, { 0xAAF7, 0xAB00 }, { 0xAB07, 0xAB08 },
+    { 0xAB0F, 0xAB10 }, { 0xAB17, 0xAB1F }, { 0xAB27, 0xAB27 }, { 0xAB2F, 0xAB2F },
+    { 0xAB6C, 0xAB6F }, { 0xABEE, 0xABEF }, { 0xABFA, 0xD7AF }, { 0xF900, 0xFAFF },
+    { 0xFB07, 0xFB12 }, { 0xFB18, 0xFB1C }, { 0xFB37, 0xFB37 }, { 0xFB3D, 0xFB3D },
+    { 0xFB3F, 0xFB3F }, { 0xFB42, 0xFB42 }, { 0xFB45, 0xFB45 }, { 0xFBC3, 0xFBD2 },
+    { 0xFD90, 0xFD91 }, { 0xFDC8, 0xFDCE }, { 0xFDD0, 0xFDEF }, { 0xFE10, 0xFE6F },
+    { 0xFE75, 0xFE75 }, { 0xFEFD, 0xFF60 }, { 0xFFBF, 0xFFC1 }, { 0xFFC8, 0xFFC9 },
+    { 0xFFD0, 0xFFD1 }, { 0xFFD8, 0xFFD9 }, { 0xFFDD, 0xFFE7 }, { 0xFFEF, 0xFFF8 },
+    { 0xFFFE, 0xFFFF }, { 0x1000C, 0x1000C }, { 0x10027, 0x10027 }, { 0x1003B, 0x1003B },
+    { 0x1003E, 0x1003E }, { 0x1004E, 0x1004F }, { 0x1005E, 0x1007F }, { 0x100FB, 0x100FF },
+    { 0x10103, 0x10106 }, { 0x10134, 0x10136 }, { 0x1018F, 0x1018F }, { 0x1019D, 0x1019F },
+    { 0x101A1, 0x101CF }, { 0x101FE, 0x1027F }, { 0x1029D, 0x1029F }, { 0x102D1, 0x102DF },
+    { 0x102FC, 0x102FF }, { 0x10324, 0x1032C }, { 0x1034B, 0x1034F }, { 0x1037B, 0x1037F },
+    { 0x1039E, 0x1039E }, { 0x103C4, 0x103C7 }, { 0x103D6, 0x103FF }, { 0x1049E, 0x1049F },
+    { 0x104AA, 0x104AF }, { 0x104D4, 0x104D7 }, { 0x104FC, 0x104FF }, { 0x10528, 0x1052F },
+    { 0x10564, 0x1056E }, { 0x1057B, 0x1057B }, { 0x1058B, 0x1058B }, { 0x10593, 0x10593 },
+    { 0x10596, 0x10596 }, { 0x105A2, 0x105A2 }, { 0x105B2, 0x105B2 }, { 0x105BA, 0x105BA },
+    { 0x105BD, 0x105FF }, { 0x10737, 0x1073F }, { 0x10756, 0x1075F }, { 0x10768, 0x1077F },
+    { 0x10786, 0x10786 }, { 0x107B1, 0x107B1 }, { 0x107BB, 0x107FF }, { 0x10806, 0x10807 },
+    { 0x10809, 0x10809 }, { 0x10836, 0x10836 }, { 0x10839, 0x1083B }, { 0x1083D, 0x1083E },
+    { 0x10856, 0x10856 }, { 0x1089F, 0x108A6 }, { 0x108B0, 0x108DF }, { 0x108F3, 0x108F3 },
+    { 0x108F6, 0x108FA }, { 0x1091C, 0x1091E }, { 0x1093A, 0x1093E }, { 0x10940, 0x1097F },
+    { 0x109B8, 0x109BB }, { 0x109D0, 0x109D1 }, { 0x10A04, 0x10A0B }, { 0x10A14, 0x10A14 },
+    { 0x10A18, 0x10A18 }, { 0x10A36, 0x10A3E }, { 0x10A49, 0x10A4F }, { 0x10A59, 0x10A5F },
+    { 0x10AA0, 0x10ABF }, { 0x10AE7, 0x10AEA }, { 0x10AF7, 0x10AFF }, { 0x10B36, 0x10B38 },
+    { 0x10B56, 0x10B57 }, { 0x10B73, 0x10B77 }, { 0x10B92, 0x10B98 }, { 0x10B9D, 0x10BA8 },
+    { 0x10BB0, 0x10BFF }, { 0x10C49, 0x10C7F }, { 0x10CB3, 0x10CBF }, { 0x10CF3, 0x10CF9 },
+    { 0x10D28, 0x10D2F }, { 0x10D3A, 0x10E5F }, { 0x10E7F, 0x10E7F }, { 0x10EAA, 0x10EAA },
+    { 0x10EAE, 0x10EAF }, { 0x10EB2, 0x10EFF }, { 0x10F28, 0x10F2F }, { 0x10F5A, 0x10F6F },
+    { 0x10F8A, 0x10FAF }, { 0x10FCC, 0x10FDF }, { 0x10FF7, 0x10FFF }, { 0x1104E, 0x11051 },
+    { 0x11076, 0x1107E }, { 0x110C3, 0x110CC }, { 0x110CE, 0x110CF }, { 0x110E9, 0x110EF },
+    { 0x110FA, 0x110FF }, { 0x11135, 0x11135 }, { 0x11148, 0x1114F }, { 0x11177, 0x1117F },
+    { 0x111E0, 0x111E0 }, { 0x111F5, 0x111FF }, { 0x11212, 0x11212 }, { 0x1123F, 0x1127F },
+    { 0x11287, 0x11287 }, { 0x11289, 0x11289 }, { 0x1128E, 0x1128E }, { 0x1129E, 0x1129E },
+    { 0x112AA, 0x112AF }, { 0x112EB, 0x112EF }, { 0x112FA, 0x112FF }, { 0x11304, 0x11304 },
+    { 0x1130D, 0x1130E }, { 0x11311, 0x11312 }, { 0x11329, 0x11329 }, { 0x11331, 0x11331 },
+    { 0x11334, 0x11334 }, { 0x1133A, 0x1133A }, { 0x11345, 0x11346 }, { 0x11349, 0x1134A },
+    { 0x1134E, 0x1134F }, { 0x11351, 0x11356 }, { 0x11358, 0x1135C }, { 0x11364, 0x113FF },
+    { 0x1145C, 0x1145C }, { 0x11462, 0x1147F }, { 0x114C8, 0x114CF }, { 0x114DA, 0x1157F },
+    { 0x115B6, 0x115B7 }, { 0x115DE, 0x115FF }, { 0x11645, 0x1164F }, { 0x1165A, 0x1165F },
+    { 0x1166D, 0x1167F }, { 0x116BA, 0x116BF }, { 0x116CA, 0x116FF }, { 0x1171B, 0x1171C },
+    { 0x1172C, 0x1172F }, { 0x11747, 0x117FF }, { 0x1183C, 0x1189F }, { 0x118F3, 0x118FE },
+    { 0x11907, 0x11908 }, { 0x1190A, 0x1190B }, { 0x11914, 0x11914 }, { 0x11917, 0x11917 },
+    { 0x11936, 0x11936 }, { 0x11939, 0x1193A }, { 0x11947, 0x1194F }, { 0x1195A, 0x1199F },
+    { 0x119A8, 0x119A9 }, { 0x119D8, 0x119D9 }, { 0x119E5, 0x119FF }, { 0x11A48, 0x11A4F },
+    { 0x11AA3, 0x11AAF }, { 0x11AF9, 0x11BFF }, { 0x11C09, 0x11C09 }, { 0x11C37, 0x11C37 },
+    { 0x11C46, 0x11C4F }, { 0x11C6D, 0x11C6F }, { 0x11C90, 0x11CA8 }, { 0x11CB7, 0x11CFF },
+    { 0x11D07, 0x11D07 }, { 0x11D0A, 0x11D0A }, { 0x11D37, 0x11D3E }, { 0x11D48, 0x11D4F },
+    { 0x11D5A, 0x11D5F }, { 0x11D66, 0x11D66 }, { 0x11D69, 0x11D69 }, { 0x11D8F, 0x11D92 },
+    { 0x11D99, 0x11D9F }, { 0x11DAA, 0x11EDF }, { 0x11EF9, 0x11FAF }, { 0x11FB1, 0x11FBF },
+    { 0x11FF2, 0x11FFE }, { 0x1239A, 0x123FF }, { 0x1246F, 0x1246F }, { 0x12475, 0x1247F },
+    { 0x12544, 0x12F8F }, { 0x12FF3, 0x12FFF }, { 0x1342F, 0x143FF }, { 0x14647, 0x167FF },
+    { 0x16A39, 0x16A3F }, { 0x16A5F, 0x16A5F }, { 0x16A6A, 0x16A6D }, { 0x16ABF, 0x16ABF },
+    { 0x16ACA, 0x16ACF }, { 0x16AEE, 0x16AEF }, { 0x16AF6, 0x16AFF }, { 0x16B46, 0x16B4F },
+    { 0x16B5A, 0x16B5A }, { 0x16B62, 0x16B62 }, { 0x16B78, 0x16B7C }, { 0x16B90, 0x16E3F },
+    { 0x16E9B, 0x16EFF }, { 0x16F4B, 0x16F4E }, { 0x16F88, 0x16F8E }, { 0x16FA0, 0x1BBFF },
+    { 0x1BC6B, 0x1BC6F }, { 0x1BC7D, 0x1BC7F }, { 0x1BC89, 0x1BC8F }, { 0x1BC9A, 0x1BC9B },
+    { 0x1BCA4, 0x1CF4F }, { 0x1CFC4, 0x1CFFF }, { 0x1D0F6, 0x1D0FF }, { 0x1D127, 0x1D128 },
+    { 0x1D1EB, 0x1D1FF }, { 0x1D246, 0x1D2DF }, { 0x1D2F4, 0x1D2FF }, { 0x1D357, 0x1D35F },
+    { 0x1D379, 0x1D3FF }, { 0x1D455, 0x1D455 }, { 0x1D49D, 0x1D49D }, { 0x1D4A0, 0x1D4A1 },
+    { 0x1D4A3, 0x1D4A4 }, { 0x1D4A7, 0x1D4A8 }, { 0x1D4AD, 0x1D4AD }, { 0x1D4BA, 0x1D4BA },
+    { 0x1D4BC, 0x1D4BC }, { 0x1D4C4, 0x1D4C4 }, { 0x1D506, 0x1D506 }, { 0x1D50B, 0x1D50C },
+    { 0x1D515, 0x1D515 }, { 0x1D51D, 0x1D51D }, { 0x1D53A, 0x1D53A }, { 0x1D53F, 0x1D53F },
+    { 0x1D545, 0x1D545 }, { 0x1D547, 0x1D549 }, { 0x1D551, 0x1D551 }, { 0x1D6A6, 0x1D6A7 },
+    { 0x1D7CC, 0x1D7CD }, { 0x1DA8C, 0x1DEFF }, { 0x1DF1F, 0x1E0FF }, { 0x1E12D, 0x1E12F },
+    { 0x1E13E, 0x1E13F }, { 0x1E14A, 0x1E14D }, { 0x1E150, 0x1E28F }, { 0x1E2AF, 0x1E2BF },
+    { 0x1E2FA, 0x1E2FE }, { 0x1E300, 0x1E7DF }, { 0x1E7E7, 0x1E7E7 }, { 0x1E7EC, 0x1E7EC },
+    { 0x1E7EF, 0x1E7EF }, { 0x1E7FF, 0x1E7FF }, { 0x1E8C5, 0x1E8C6 }, { 0x1E8D7, 0x1E8FF },
+    { 0x1E94C, 0x1E94F }, { 0x1E95A, 0x1E95D }, { 0x1E960, 0x1EC70 }, { 0x1ECB5, 0x1ED00 },
+    { 0x1ED3E, 0x1EDFF }, { 0x1EE04, 0x1EE04 }, { 0x1EE20, 0x1EE20 }, { 0x1EE23, 0x1EE23 },
+    { 0x1EE25, 0x1EE26 }, { 0x1EE28, 0x1EE28 }, { 0x1EE33, 0x1EE33 }, { 0x1EE38, 0x1EE38 },
+    { 0x1EE3A, 0x1EE3A }, { 0x1EE3C, 0x1EE41 }, { 0x1EE43, 0x1EE46 }, { 0x1EE48, 0x1EE48 },
+    { 0x1EE4A, 0x1EE4A }, { 0x1EE4C, 0x1EE4C }, { 0x1EE50, 0x1EE50 }, { 0x1EE53, 0x1EE53 },
+    { 0x1EE55, 0x1EE56 }, { 0x1EE58, 0x1EE58 }, { 0x1EE5A, 0x1EE5A }, { 0x1EE5C, 0x1EE5C },
+    { 0x1EE5E, 0x1EE5E }, { 0x1EE60, 0x1EE60 }, { 0x1EE63, 0x1EE63 }, { 0x1EE65, 0x1EE66 },
+    { 0x1EE6B, 0x1EE6B }, { 0x1EE73, 0x1EE73 }, { 0x1EE78, 0x1EE78 }, { 0x1EE7D, 0x1EE7D },
+    { 0x1EE7F, 0x1EE7F }, { 0x1EE8A, 0x1EE8A }, { 0x1EE9C, 0x1EEA0 }, { 0x1EEA4, 0x1EEA4 },
+    { 0x1EEAA, 0x1EEAA }, { 0x1EEBC, 0x1EEEF }, { 0x1EEF2, 0x1EFFF }, { 0x1F004, 0x1F004 },
+    { 0x1F02C, 0x1F02F }, { 0x1F094, 0x1F09F }, { 0x1F0AF, 0x1F0B0 }, { 0x1F0C0, 0x1F0C0 },
+    { 0x1F0CF, 0x1F0D0 }, { 0x1F0F6, 0x1F0FF }, { 0x1F18E, 0x1F18E }, { 0x1F191, 0x1F19A },
+    { 0x1F1AE, 0x1F1E5 }, { 0x1F200, 0x1F320 }, { 0x1F32D, 0x1F335 }, { 0x1F337, 0x1F37C },
+    { 0x1F37E, 0x1F393 }, { 0x1F3A0, 0x1F3CA }, { 0x1F3CF, 0x1F3D3 }, { 0x1F3E0, 0x1F3F0 },
+    { 0x1F3F4, 0x1F3F4 }, { 0x1F3F8, 0x1F43E }, { 0x1F440, 0x1F440 }, { 0x1F442, 0x1F4FC },
+    { 0x1F4FF, 0x1F53D }, { 0x1F54B, 0x1F54E }, { 0x1F550, 0x1F567 }, { 0x1F57A, 0x1F57A },
+    { 0x1F595, 0x1F596 }, { 0x1F5A4, 0x1F5A4 }, { 0x1F5FB, 0x1F64F }, { 0x1F680, 0x1F6C5 },
+    { 0x1F6CC, 0x1F6CC }, { 0x1F6D0, 0x1F6D2 }, { 0x1F6D5, 0x1F6DF }, { 0x1F6EB, 0x1F6EF },
+    { 0x1F6F4, 0x1F6FF }, { 0x1F774, 0x1F77F }, { 0x1F7D9, 0x1F7FF }, { 0x1F80C, 0x1F80F },
+    { 0x1F848, 0x1F84F }, { 0x1F85A, 0x1F85F }, { 0x1F888, 0x1F88F }, { 0x1F8AE, 0x1F8AF },
+    { 0x1F8B2, 0x1F8FF }, { 0x1F90C, 0x1F93A }, { 0x1F93C, 0x1F945 }, { 0x1F947, 0x1F9FF },
+    { 0x1FA54, 0x1FA5F }, { 0x1FA6E, 0x1FAFF }, { 0x1FB93, 0x1FB93 }, { 0x1FBCB, 0x1FBEF },
+    { 0x1FBFA, 0xEFFFF }, { 0xFFFFE, 0xFFFFF }, { 0x10FFFE, 0x10FFFF }
+};
+
+/**
+ * Tells whether a codepoint is in a table of ranges, with a binary search.
+ * 
+ * Cost: O(log r), where r is the number of ranges
+ * 
+ * @param table Sorted and disjoint ranges of codepoints, both ends included
+ * @param size Number of ranges
+ * @param c A codepoint
+ * @return True if some range contains c
+ */
+bool inRanges(const uint32_t table[][2], int size, uint32_t c)
+{
+    if(c < table[0][0] or c > table[size-1][1])
+        return false;
+    
+    int l = 0;
+    int r = size - 1;
+    
+    // Invariant: if some range contains c, it is in table[l..r]
+    while(l < r)
+    {
+        int m = (l + r) / 2;
+        
+        if(table[m][1] < c)
+            l = m + 1;
+        else
+            r = m;
+    }
+    
+    return table[l][0] <= c and c <= table[l][1];
+}
+
+/**
+ * Display width of a Unicode codepoint in a terminal, as wcwidth() of a UTF-8 locale.
+ * Combining marks and zero width characters take no columns (ZERO_WIDTH), East Asian
+ * wide and fullwidth characters take two columns (DOUBLE_WIDTH) and the rest take one
+ * column.
+ * 
+ * Cost: O(log r), where r is the number of ranges of the tables
+ * 
+ * @param c A codepoint
+ * @return The number of columns of c
+ */
+int codepointWidth(uint32_t c)
+{
+    if(inRanges(ZERO_WIDTH, sizeof(ZERO_WIDTH) / sizeof(ZERO_WIDTH[0]), c))
+        return 0;
+    
+    if(inRanges(DOUBLE_WIDTH, sizeof(DOUBLE_WIDTH) / sizeof(DOUBLE_WIDTH[0]), c))
+        return 2;
+    
+    return 1;
+}
+
+/**
+ * Index of the first byte of a block of 8 bytes whose high bit is set in flags.
+ * The block is loaded with memcpy, so its first byte is the lowest one in little endian
+ * processors and the highest one in big endian processors.
+ * @param flags High bits of the flagged bytes of a block, not 0
+ * @return Index of the first flagged byte, in [0, 8)
+ */
+inline int firstFlagged(uint64_t flags)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_clzll(flags) / 8;
+#else
+    return __builtin_ctzll(flags) / 8;
+#endif
+}
+
+/**
+ * Scans the word that starts at text[start] and computes its display width in the same pass.
+ * Blocks of 8 bytes are checked at once (SWAR): the separators, control bytes and bytes of
+ * UTF-8 sequences of the block are flagged, and the printable ASCII bytes before the first
+ * flagged one are counted as one column each without looking at them one by one. Then,
+ * the flagged byte is scanned alone: a separator ends the word and a UTF-8 sequence is
+ * decoded. Invalid UTF-8 bytes take one column each.
+ * Compiled with -DSCALAR_SCAN (make scalar), every byte is scanned alone, which is the
+ * baseline of the tokenizer benchmark of bench.rb.
+ * 
+ * Cost: O(length of the word)
+ * 
+ * @param text Text being tokenized
+ * @param start Index of the first byte of the word, that must not be a separator
+ * @param end Size of the text
+ * @param width Destination of the display width of the word
+ * @return Index of the first byte after the word
+ */
+size_t scanWord(const char *text, size_t start, size_t end, int &width)
+{
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    
+    size_t i = start;
+    width = 0;
+    
+    while(i < end)
+    {
+#ifndef SCALAR_SCAN
+        if(i + 8 <= end)
+        {
+            uint64_t block;
+            memcpy(&block, text + i, 8);
+            
+            // The high bit of a byte < 0x21 (separator or control) or >= 0x80 (UTF-8
+            // sequence) is set. A subtraction only borrows from a flagged byte, so the
+            // bytes after the first flagged one may be wrong, but it is always right.
+            uint64_t flags = ((block - ones * 0x21) | block) & highs;
+            
+            if(flags == 0)
+            {
+                i += 8;
+                width += 8;
+                continue;
+            }
+            
+            // Printable ASCII bytes before the flagged one
+            int ascii = firstFlagged(flags);
+            i += ascii;
+            width += ascii;
+        }
+#endif
+        
+        unsigned char c = text[i];
+        
+        if(isSeparator(c))
+            break;
+        
+        if(c < 0x80)
+        {
+            ++i;
+            ++width;
+            continue;
+        }
+        
+        // Length and payload of the lead byte of the UTF-8 sequence
+        int length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+        uint32_t codepoint = c & (0x7F >> length);
+        
+        int k = 1;
+        
+        while(k < length and i + k < end and (text[i+k] & 0xC0) == 0x80)
+        {
+            codepoint = (codepoint << 6) | (text[i+k] & 0x3F);
+            ++k;
+        }
+        
+        // Truncated or invalid sequences take one column per byte
+        if(length == 1 or k < length)
+        {
+            i += k;
+            width += k;
+        }
+        else
+        {
+            i += length;
+            width += codepointWidth(codepoint);
+        }
+    }
+    
+    return i;
+}
+
+#ifdef AVX2_KERNELS
+/**
+ * Tells whether the processor supports AVX2, checked once.
+ * @return True if the AVX2 kernels can be used
+ */
+inline bool supportsAVX2()
+{
+    static bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    
+    return supported;
+}
+#endif
+
+/**
+ * Penalty of a line: the square of the difference between its width and the target width.
+ * Policy for the dynamic programmings, which are specialized at compile time with it, so
+ * that both versions of apply() are inlined into the loops and the kernels.
+ */
+struct SquaredPenalty
+{
+    /**
+     * @param slack Width of the line minus the target line width
+     * @return Penalty of the line
+     */
+    static inline long long apply(long long slack)
+    {
+        return slack * slack;
+    }
+    
+#ifdef AVX2_KERNELS
+    /**
+     * @param slack Four slacks, one in the low 32 bits of every 64-bit lane
+     * @return Four penalties, as 64-bit integers
+     */
+    static inline __attribute__((target("avx2"))) __m256i apply(__m256i slack)
+    {
+        return _mm256_mul_epi32(slack, slack);
+    }
+#endif
+};
+
+/**
+ * Penalty used by every arrangement.
+ * Paragraph::dominated() relies on it being SquaredPenalty.
+ */
+typedef SquaredPenalty LinePenalty;
+
 /**
  * Represents a paragraph.
  */
 class Paragraph
 {
+    friend class StreamedParagraph;
+    
     /**
      * Words of the paragraph.
      * From now on:
@@ -17,6 +581,12 @@ class Paragraph
      */
     vector<string> words;
     
+    /**
+     * Given 0 <= i < n:
+     * wordWidths[i] = display width of words[i], in columns
+     */
+    vector<int> wordWidths;
+    
     /**
      * Given 0 <= i < n:
      * lines[i] = k, where words[k] is the word that should start the line where
@@ -28,7 +598,7 @@ class Paragraph
      * Given 0 <= i < n:
      * optimalCosts[i] = optimal cost of arranging the words[0..i]
      */
-    vector<int> optimalCosts;
+    vector<long long> optimalCosts;
     
     /**
      * Given 0 <= i < n:
@@ -36,6 +606,50 @@ class Paragraph
      */
     vector<int> lineWidths;
     
+    /**
+     * Gap left by the edits, so the next nearby edit does not move the rest of the words.
+     * The vectors above have n + gapSize positions and, given 0 <= i < n, the values of
+     * words[i] are stored at the position i if i < gap and at i + gapSize otherwise.
+     * See moveGap().
+     */
+    int gap;
+    int gapSize;
+    
+    /**
+     * Pending offsets of the words after the gap: their optimal cost, line start and line
+     * width are the stored ones plus tailCost, tailLine and tailWidth. An edit offsets the
+     * whole converged tail by updating them.
+     */
+    long long tailCost;
+    int tailLine;
+    int tailWidth;
+    
+    /**
+     * Target line width of the last single-width arrangement.
+     * The editing methods keep lines and optimalCosts valid for this width.
+     */
+    int targetWidth;
+    
+    /**
+     * Target widths of the last multi-width arrangement.
+     * From now on:
+     * k = widths.size()
+     */
+    vector<int> widths;
+    
+    /**
+     * Given 0 <= i < n and 0 <= w < k:
+     * widthLines[w*n + i] = lines[i] when the target line width is widths[w]
+     */
+    vector<int> widthLines;
+    
+    /**
+     * Given 0 <= i < n and 0 <= w < k:
+     * widthCosts[w*n + i] = optimalCosts[i] when the target line width is widths[w]
+     * Every width has its own contiguous row, so bestLine() scans it like optimalCosts.
+     */
+    vector<long long> widthCosts;
+    
     /**
      * Calculates the line widths given the target line width.
      * 
@@ -47,12 +661,15 @@ class Paragraph
      */
     void computeLineWidths()
     {
+        // The words have to be contiguous
+        closeGap();
+        
         // Initialize lineWidths structure
         lineWidths = vector<int>(words.size());
         
         // Base case
         // Line width of the line that only contains words[0] equals to words[0] width
-        lineWidths[0] = words[0].size();
+        lineWidths[0] = wordWidths[0];
         
         // Line widths
         // Given 0 <= i < n:
@@ -64,7 +681,7 @@ class Paragraph
             // 1. The width of the line that starts with words[0] and ends with words[i-1]
             // 2. Width of words[i]
             // 3. 1 (because the additional space separator)
-            lineWidths[i] = lineWidths[i-1] + words[i].size() + 1;
+            lineWidths[i] = lineWidths[i-1] + wordWidths[i] + 1;
             
             // We are doing constant work O(1) for every word i. Thus, the cost of this loop is:
             // (n-1) * O(1) = O(n)
@@ -78,7 +695,7 @@ class Paragraph
      * @param width Target line width
      * @return Cost of having words[i..j] on the same line
      */
-    int cost(int i, int j, int width)
+    long long cost(int i, int j, int width)
     {
         // Square root of the cost of having words[0..j] on the same line
         int cost_2 = lineWidths[j] - width;
@@ -88,8 +705,160 @@ class Paragraph
             cost_2 = cost_2 - lineWidths[i-1] - 1;
         
         // Return the cost
-        return cost_2 * cost_2;
+        return LinePenalty::apply(cost_2);
+    }
+    
+    /**
+     * Finds the best line that ends with words[j] among the lines words[i..j], 1 <= i <= j,
+     * for G target widths at once, updating min_cost[g] and min_index[g] if one of them is
+     * strictly better. This is the inner loop of wordwrap(width), with G = 1, and of
+     * wordwrap(targets): the cost of every candidate for widths[g] is
+     *     rows[g][i-1] + Penalty::apply(lineWidths[j] - lineWidths[i-1] - 1 - widths[g])
+     * 
+     * Every lineWidths[i-1] is loaded once and evaluated against the G widths.
+     * When the processor supports AVX2, the candidates are first evaluated by
+     * bestLineAVX2() in blocks. The remaining candidates are evaluated by the scalar loop,
+     * which is also the fallback without AVX2.
+     * 
+     * Cost: O(j * G)
+     * 
+     * @param j Word that ends the line
+     * @param widths Target line widths
+     * @param rows Optimal costs of the words before the line, one row for every width
+     * @param min_cost Minimum cost found for every width, updated
+     * @param min_index Start of the line of min_cost, updated
+     */
+    template<class Penalty, int G> void bestLine(int j, const int *widths,
+            const long long *const *rows, long long *min_cost, int *min_index)
+    {
+        // Width of the line words[i..j] is ends[g] - lineWidths[i-1]
+        int ends[G];
+        
+        for(int g = 0; g < G; ++g)
+            ends[g] = lineWidths[j] - 1 - widths[g];
+        
+        int i = 1;
+        
+        STAT_ADD(candidates, (long long) j * G);
+        
+#ifdef AVX2_KERNELS
+        if(j >= 8 and supportsAVX2())
+            i = bestLineAVX2<Penalty, G>(j, ends, rows, min_cost, min_index);
+#endif
+        
+        for(; i <= j; ++i)
+        {
+            int previous = lineWidths[i-1];
+            
+            for(int g = 0; g < G; ++g)
+            {
+                long long new_cost = rows[g][i-1] + Penalty::apply(ends[g] - previous);
+                
+                if(new_cost < min_cost[g])
+                {
+                    min_cost[g] = new_cost;
+                    min_index[g] = i;
+                }
+            }
+        }
+    }
+    
+#ifdef AVX2_KERNELS
+    /**
+     * AVX2 part of bestLine(): evaluates the candidates 1 <= i <= j in blocks of four
+     * 64-bit lanes. A single width uses two sets of lanes, so consecutive blocks do not wait
+     * for each other; several widths are already independent chains. Every lane keeps its
+     * own minimum and index, updated only when strictly better, and the lanes are reduced
+     * choosing the smallest index on ties. Every lane sees its candidates in increasing
+     * order and lanes start with the current minimum, so the first minimum wins, as in the
+     * scalar loop.
+     * 
+     * Only called when supportsAVX2() is true.
+     * 
+     * Cost: O(j * G)
+     * 
+     * @param j Word that ends the line, j >= 8
+     * @param ends lineWidths[j] - 1 - widths[g], for every width
+     * @param rows Optimal costs of the words before the line, one row for every width
+     * @param min_cost Minimum cost found for every width, updated
+     * @param min_index Start of the line of min_cost, updated
+     * @return First candidate not evaluated
+     */
+    template<class Penalty, int G> __attribute__((target("avx2")))
+    int bestLineAVX2(int j, const int *ends, const long long *const *rows, long long *min_cost,
+            int *min_index)
+    {
+        const int SETS = G == 1 ? 2 : 1;
+        
+        __m256i endLanes[G];
+        __m256i mins[SETS][G];
+        __m256i argmins[SETS][G];
+        
+        for(int g = 0; g < G; ++g)
+        {
+            endLanes[g] = _mm256_set1_epi64x(ends[g]);
+            
+            for(int set = 0; set < SETS; ++set)
+            {
+                mins[set][g] = _mm256_set1_epi64x(min_cost[g]);
+                argmins[set][g] = _mm256_set1_epi64x(min_index[g]);
+            }
+        }
+        
+        __m256i indexes = _mm256_setr_epi64x(1, 2, 3, 4);
+        __m256i step = _mm256_set1_epi64x(4);
+        int i = 1;
+        
+        for(; i + 4 * SETS - 1 <= j; i += 4 * SETS)
+        {
+            for(int set = 0; set < SETS; ++set)
+            {
+                int k = i + 4 * set;
+                
+                __m128i loaded = _mm_loadu_si128((const __m128i *) &lineWidths[k-1]);
+                __m256i previous = _mm256_cvtepi32_epi64(loaded);
+                
+                for(int g = 0; g < G; ++g)
+                {
+                    __m256i slack = _mm256_sub_epi64(endLanes[g], previous);
+                    __m256i costs = _mm256_loadu_si256((const __m256i *) &rows[g][k-1]);
+                    __m256i candidates = _mm256_add_epi64(costs, Penalty::apply(slack));
+                    
+                    __m256i better = _mm256_cmpgt_epi64(mins[set][g], candidates);
+                    
+                    mins[set][g] = _mm256_blendv_epi8(mins[set][g], candidates, better);
+                    argmins[set][g] = _mm256_blendv_epi8(argmins[set][g], indexes, better);
+                }
+                
+                indexes = _mm256_add_epi64(indexes, step);
+            }
+        }
+        
+        for(int g = 0; g < G; ++g)
+        {
+            long long lane_costs[4 * SETS];
+            long long lane_indexes[4 * SETS];
+            
+            for(int set = 0; set < SETS; ++set)
+            {
+                _mm256_storeu_si256((__m256i *) &lane_costs[4 * set], mins[set][g]);
+                _mm256_storeu_si256((__m256i *) &lane_indexes[4 * set], argmins[set][g]);
+            }
+            
+            for(int lane = 0; lane < 4 * SETS; ++lane)
+            {
+                if(lane_costs[lane] < min_cost[g] or
+                   (lane_costs[lane] == min_cost[g] and lane_indexes[lane] < min_index[g]))
+                {
+                    min_cost[g] = lane_costs[lane];
+                    min_index[g] = lane_indexes[lane];
+                }
+            }
+        }
+        
+        return i;
     }
+#endif
     
     /**
      * Prints the paragraph words[0..index] in lines recursively.
@@ -107,12 +876,12 @@ class Paragraph
         
         // lines[index] - 1 is the word before the actual line
         // We can use recursivity to print words[0..lines[index]-1] correctly (by induction).
-        printLines(lines[index] - 1);
+        printLines(lineStart(index) - 1);
         
         // Now, we only need to print the current line that contains words[lines[index]..index]
-        for(int i = lines[index]; i <= index; ++i)
+        for(int i = lineStart(index); i <= index; ++i)
         {
-            cout << words[i];
+            cout << word(i);
             
             if(i != index)
                 cout << ' ';
@@ -121,56 +890,538 @@ class Paragraph
         cout << endl;
     }
     
-public:
     /**
-     * Reads a paragraph from the default input stream.
-     * It reads from the input stream until a blank line is read.
-     *
-     * Cost: O(n), where n is the number of words read
+     * @param i Index of the word, 0 <= i < n
+     * @return words[i], wherever the gap is
      */
-    void read()
+    const string &word(int i)
+    {
+        return words[i < gap ? i : i + gapSize];
+    }
+    
+    /**
+     * @param i Index of the word, 0 <= i < n
+     * @return lines[i], wherever the gap is and including the pending offset
+     */
+    int lineStart(int i)
+    {
+        return i < gap ? lines[i] : lines[i + gapSize] + tailLine;
+    }
+    
+    /**
+     * @param i Index of the word, 0 <= i < n
+     * @return optimalCosts[i], wherever the gap is and including the pending offset
+     */
+    long long optimalCost(int i)
+    {
+        return i < gap ? optimalCosts[i] : optimalCosts[i + gapSize] + tailCost;
+    }
+    
+    /**
+     * @param i Index of the word, 0 <= i < n
+     * @return lineWidths[i], wherever the gap is and including the pending offset
+     */
+    int lineWidth(int i)
+    {
+        return i < gap ? lineWidths[i] : lineWidths[i + gapSize] + tailWidth;
+    }
+    
+    /**
+     * Moves the gap before words[position]. The words that cross it are moved to its
+     * other side, applying or removing the pending offsets of the tail.
+     * 
+     * Cost: O(|position - gap|)
+     * 
+     * @param position New gap, 0 <= position <= n
+     */
+    void moveGap(int position)
     {
-        string s;
+        while(gap > position)
+        {
+            --gap;
+            int to = gap + gapSize;
+            
+            words[to].swap(words[gap]);
+            wordWidths[to] = wordWidths[gap];
+            lines[to] = lines[gap] - tailLine;
+            optimalCosts[to] = optimalCosts[gap] - tailCost;
+            lineWidths[to] = lineWidths[gap] - tailWidth;
+        }
         
-        while(getline(cin, s))
+        while(gap < position)
         {
-            istringstream line(s);
+            int from = gap + gapSize;
             
-            bool empty = true;
-
-            while(line >> s)
-            {
-                words.push_back(s);
-                empty = false;
-            }
+            words[gap].swap(words[from]);
+            wordWidths[gap] = wordWidths[from];
+            lines[gap] = lines[from] + tailLine;
+            optimalCosts[gap] = optimalCosts[from] + tailCost;
+            lineWidths[gap] = lineWidths[from] + tailWidth;
             
-            if(empty)
-                break;
+            ++gap;
         }
-        
-        // Paragraph consists in only one line by default
-        // Every word is in the same line of the first word
-        lines = vector<int>(words.size(), 0);
     }
     
     /**
-     * Tells whether the paragraph is empty or not.
-     * @return True if the paragraph does not have any word, false otherwise
+     * Makes room for at least count words in the gap. The gap grows at least by n, like
+     * the capacity of a vector, so the insertions cost amortized constant time.
+     * 
+     * Cost: O(n) when the gap grows, constant otherwise
+     * 
+     * @param count Minimum size of the gap
      */
-    bool empty()
+    void widenGap(int count)
     {
-        return words.size() < 1;
+        if(gapSize >= count)
+            return;
+        
+        int extra = max(count - gapSize, size());
+        
+        words.insert(words.begin() + gap, extra, string());
+        wordWidths.insert(wordWidths.begin() + gap, extra, 0);
+        lines.insert(lines.begin() + gap, extra, 0);
+        optimalCosts.insert(optimalCosts.begin() + gap, extra, 0);
+        lineWidths.insert(lineWidths.begin() + gap, extra, 0);
+        
+        gapSize += extra;
     }
     
     /**
-     * Formats the words of the paragraphs in lines optimally (lowest penalty).
-     * Detailed information: https://www.jutge.org/problems/X57785_es/statement
+     * Moves the gap to the end and removes it, so the vectors are contiguous again.
      * 
-     * Every optimum arrangement can be described recursively:
-     * If n = 1, the optimum arrangement is a line with the word itself.
-     * If n > 1, there exists k: 0 <= k < n, such that the optimum arrangement is:
-     * optimumArrangement(k)
-     * words[k+1..n]
+     * Cost: O(n - gap)
+     */
+    void closeGap()
+    {
+        int n = size();
+        
+        moveGap(n);
+        
+        words.resize(n);
+        wordWidths.resize(n);
+        lines.resize(n);
+        optimalCosts.resize(n);
+        lineWidths.resize(n);
+        
+        gapSize = 0;
+        tailCost = tailLine = tailWidth = 0;
+    }
+    
+    /**
+     * Tells whether the line that starts with words[i] can not be part of any optimal
+     * arrangement of words[0..j'], for every j' > j.
+     * 
+     * Let c = lineWidths[j] - lineWidths[i-1] and X = (width of words[j+1..j']) - width.
+     * Starting the line at words[i] costs optimalCosts[i-1] + (c + X)^2, while arranging
+     * words[0..j] optimally and putting words[j+1..j'] on a new line costs
+     * optimalCosts[j] + X^2. Because X >= -width:
+     *     optimalCosts[i-1] + (c + X)^2 >= optimalCosts[i-1] + X^2 + c*(c - 2*width)
+     * Thus, if optimalCosts[i-1] + c*(c - 2*width) > optimalCosts[j] the line that starts
+     * with words[i] is strictly worse than another candidate for every j' > j. It is never
+     * selected, not even as a tie.
+     * 
+     * Cost: Constant
+     * 
+     * @param previousCost Optimal cost of arranging words[0..i-1] (0 if i = 0)
+     * @param previousWidth lineWidths[i-1] (-1 if i = 0)
+     * @param cost Optimal cost of arranging words[0..j]
+     * @param width lineWidths[j]
+     * @param target Target line width
+     * @return True if the line that starts with words[i] is dominated for every j' > j
+     */
+    static bool dominated(long long previousCost, long long previousWidth, long long cost,
+            long long width, long long target)
+    {
+        long long c = width - previousWidth;
+        
+        return previousCost + c * (c - 2 * target) > cost;
+    }
+    
+    /**
+     * Replaces words[position..position+removed-1] by the inserted words and updates
+     * lines and optimalCosts for the target width of the last wordwrap(width).
+     * 
+     * The arrangement of words[0..position-1] does not change. The dynamic programming is
+     * recomputed forward from the edit point, ignoring the candidates that dominated() proves
+     * useless, and it stops as soon as, at some word j after the edit:
+     * 1. Every line that contains an edited word (or crosses a removed one) is dominated,
+     *    both in the old and in the new arrangement.
+     * 2. For every candidate that is still alive in any of them, the new optimal cost of
+     *    the words before it differs from the old one by the same constant.
+     * From then on, both dynamic programmings choose among the same candidates with costs
+     * that differ by that constant, so the old lines (shifted) and costs (plus the constant)
+     * of the remaining words are still optimal.
+     * 
+     * The converged tail is not rewritten: its offsets are added to the pending ones of the
+     * words after the gap, which is left right after the recomputed words.
+     * 
+     * Cost:
+     * O(a * d) for the recomputed words, where a is the number of words until convergence
+     * and d is the number of candidates alive, which depends on the target width and not on n,
+     * plus O(|position - g|) to move the gap from g, the end of the region recomputed by the
+     * previous edit, and amortized constant time for every inserted word to widen the gap.
+     * Thus, an edit near the previous one costs time proportional to the affected region,
+     * independently of n.
+     * 
+     * @param position Index of the first replaced word
+     * @param removed Number of words to remove
+     * @param inserted Words to insert at position
+     * @return The penalty of the new optimal arrangement
+     */
+    long long edit(int position, int removed, const vector<string> &inserted)
+    {
+        int p = position;
+        int added = inserted.size();
+        int shift = added - removed;
+        int n = size() + shift;
+        long long target = targetWidth;
+        
+        // Display widths and line widths of the inserted words
+        vector<int> insertedWidths(added);
+        vector<int> insertedLineWidths(added);
+        
+        int base = p > 0 ? lineWidth(p - 1) : -1;
+        int last = base;
+        
+        for(int a = 0; a < added; ++a)
+        {
+            scanWord(inserted[a].data(), 0, inserted[a].size(), insertedWidths[a]);
+            
+            last += insertedWidths[a] + 1;
+            insertedLineWidths[a] = last;
+        }
+        
+        // Difference between the new and the old line widths of the words after the edit
+        int delta = last - (removed > 0 ? lineWidth(p + removed - 1) : base);
+        
+        // Old and new values, where the index -1 stands for the empty arrangement.
+        // New values of the recomputed words are stored in costs and starts.
+        vector<long long> costs;
+        vector<int> starts;
+        
+        auto oldCost = [&](int k) { return k < 0 ? 0LL : optimalCost(k); };
+        auto oldWidth = [&](int k) { return k < 0 ? -1 : lineWidth(k); };
+        auto newCost = [&](int k) { return k < p ? oldCost(k) : costs[k - p]; };
+        auto newWidth = [&](int k)
+        {
+            if(k < p)
+                return oldWidth(k);
+            
+            if(k < p + added)
+                return insertedLineWidths[k - p];
+            
+            return lineWidth(k - shift) + delta;
+        };
+        
+        // First candidate not proven dominated. Lines that start before words[p] are
+        // dominated if c*(c - 2*target) > optimalCosts[p-1], which is monotone in the start.
+        int alive = p;
+        
+        while(alive > 0 and not dominated(0, oldWidth(alive - 2), oldCost(p - 1),
+                oldWidth(p - 1), target))
+            --alive;
+        
+        int oldAlive = alive;
+        
+        // Offsets between new and old costs, from the last word before the unchanged ones:
+        // offset = newCost(k) - oldCost(k - shift) for every k: agree <= k <= j
+        int first = p + added - 1;
+        long long offset = 0;
+        int agree = first;
+        
+        if(added == 0)
+            offset = oldCost(p - 1) - oldCost(p - 1 + removed);
+        
+        int converged = n - 1;
+        
+        STAT_ADD(edits, 1);
+        
+        for(int j = p; j < n; ++j)
+        {
+            // Same dynamic programming of wordwrap(width) on the candidates alive
+            int width = newWidth(j);
+            long long min_cost = -1;
+            int min_index = alive;
+            
+            STAT_ADD(recomputed, 1);
+            STAT_ADD(candidates, j - alive + 1);
+            
+            for(int i = alive; i <= j; ++i)
+            {
+                long long new_cost = newCost(i - 1) +
+                        LinePenalty::apply(width - newWidth(i - 1) - 1 - targetWidth);
+                
+                if(i == alive or new_cost < min_cost)
+                {
+                    min_cost = new_cost;
+                    min_index = i;
+                }
+            }
+            
+            costs.push_back(min_cost);
+            starts.push_back(min_index);
+            
+            while(alive <= j and dominated(newCost(alive - 1), newWidth(alive - 1), min_cost,
+                    width, target))
+                ++alive;
+            
+            if(j < first)
+                continue;
+            
+            // Old counterpart of words[j]
+            int o = j - shift;
+            
+            if(j > first)
+            {
+                while(oldAlive <= o and dominated(oldCost(oldAlive - 1), oldWidth(oldAlive - 1),
+                        oldCost(o), oldWidth(o), target))
+                    ++oldAlive;
+            }
+            
+            long long current = min_cost - oldCost(o);
+            
+            if(j == first or current != offset)
+            {
+                offset = current;
+                agree = j;
+            }
+            
+            if(j > first and alive > first and oldAlive + shift > first and
+                    agree < min(alive, oldAlive + shift))
+            {
+                converged = j;
+                break;
+            }
+        }
+        
+        // The removed words join the gap and the inserted ones are written before it
+        moveGap(p);
+        gapSize += removed;
+        widenGap(added);
+        
+        for(int a = 0; a < added; ++a)
+        {
+            words[gap] = inserted[a];
+            wordWidths[gap] = insertedWidths[a];
+            lineWidths[gap] = insertedLineWidths[a];
+            
+            ++gap;
+            --gapSize;
+        }
+        
+        // Offset the converged tail lazily and move the recomputed words before the gap
+        tailCost += offset;
+        tailLine += shift;
+        tailWidth += delta;
+        
+        moveGap(converged + 1);
+        
+        for(int k = p; k <= converged; ++k)
+        {
+            optimalCosts[k] = costs[k - p];
+            lines[k] = starts[k - p];
+        }
+        
+        return n > 0 ? optimalCost(n - 1) : 0;
+    }
+    
+    /**
+     * Row minima of one step of the parallel wordwrap.
+     * Given the optimal costs of arranging words[0..s-1] for every slo <= s <= shi, finds for
+     * every tlo <= t <= thi the leftmost s that minimizes the cost of arranging words[0..t-1]
+     * as words[0..s-1] plus a line with words[s..t-1], and merges it into best[t] and
+     * bestStart[t], keeping the previous value on ties (it comes from a smaller s).
+     * 
+     * The cost of a line is a convex function of lineWidths[t-1] - lineWidths[s-1], so the
+     * matrix of candidates is Monge and the leftmost minimum of row t is monotone in t. Thus,
+     * the minimum of the central row splits the candidates of the rows above and below it,
+     * and both halves are independent: while threads > 1, one of them runs on a new thread.
+     * 
+     * Cost: O((thi - tlo + shi - slo) * log(thi - tlo))
+     * 
+     * @param costs costs[s] = optimal cost of arranging words[0..s-1]
+     * @param best Best cost found for every t
+     * @param bestStart Line start of best[t]
+     * @param tlo First row
+     * @param thi Last row
+     * @param slo First candidate
+     * @param shi Last candidate
+     * @param width Target line width
+     * @param threads Number of threads available for this call
+     */
+    void parallelRows(const vector<long long> &costs, vector<long long> &best, vector<int> &bestStart,
+            int tlo, int thi, int slo, int shi, int width, int threads)
+    {
+        if(tlo > thi)
+            return;
+        
+        int t = (tlo + thi) / 2;
+        long long min_cost = 0;
+        int min_index = slo;
+        
+        STAT_ADD(candidates, shi - slo + 1);
+        
+        for(int s = slo; s <= shi; ++s)
+        {
+            int slack = lineWidths[t-1] - (s > 0 ? lineWidths[s-1] + 1 : 0) - width;
+            long long new_cost = costs[s] + LinePenalty::apply(slack);
+            
+            if(s == slo or new_cost < min_cost)
+            {
+                min_cost = new_cost;
+                min_index = s;
+            }
+        }
+        
+        if(min_cost < best[t])
+        {
+            best[t] = min_cost;
+            bestStart[t] = min_index;
+        }
+        
+        // Small blocks are not worth a new thread
+        if(threads > 1 and thi - tlo > 4096)
+        {
+            thread above(&Paragraph::parallelRows, this, cref(costs), ref(best), ref(bestStart),
+                    tlo, t - 1, slo, min_index, width, threads / 2);
+            
+            parallelRows(costs, best, bestStart, t + 1, thi, min_index, shi, width,
+                    threads - threads / 2);
+            
+            above.join();
+        }
+        else
+        {
+            parallelRows(costs, best, bestStart, tlo, t - 1, slo, min_index, width, 1);
+            parallelRows(costs, best, bestStart, t + 1, thi, min_index, shi, width, 1);
+        }
+    }
+    
+    /**
+     * Computes costs[l+1..r] of the parallel wordwrap, where costs[t] is the optimal cost of
+     * arranging words[0..t-1], dividing and conquering over t (offline to online):
+     * 1. Solve the left half costs[l..m] recursively.
+     * 2. Every t of the right half takes into account the candidates of the left half,
+     *    with parallelRows().
+     * 3. Solve the right half recursively, which adds its own candidates.
+     * Every t receives its candidates in increasing order of s, so the ties are solved as in
+     * wordwrap(width).
+     * 
+     * Cost: O(n * log^2(n)) where n = r - l
+     * 
+     * @param costs Optimal costs, costs[l] must be already computed
+     * @param best Best cost found for every t
+     * @param bestStart Line start of best[t]
+     * @param l First index
+     * @param r Last index
+     * @param width Target line width
+     * @param threads Number of threads
+     */
+    void parallelWordwrap(vector<long long> &costs, vector<long long> &best, vector<int> &bestStart,
+            int l, int r, int width, int threads)
+    {
+        if(l == r)
+        {
+            // Every candidate of costs[l] has been already merged
+            costs[l] = best[l];
+            return;
+        }
+        
+        int m = (l + r) / 2;
+        
+        parallelWordwrap(costs, best, bestStart, l, m, width, threads);
+        parallelRows(costs, best, bestStart, m + 1, r, l, m, width, threads);
+        parallelWordwrap(costs, best, bestStart, m + 1, r, width, threads);
+    }
+    
+public:
+    Paragraph() : gap(0), gapSize(0), tailCost(0), tailLine(0), tailWidth(0)
+    {
+    }
+    
+    /**
+     * Reads a paragraph from the input text, starting at position, until a blank line.
+     * The text is the whole input (see readInput()) and it is tokenized in place with
+     * scanWord(), which also computes the display width of every word, so UTF-8 text is
+     * wrapped by columns instead of by bytes.
+     *
+     * Cost: O(n), where n is the number of bytes read
+     * 
+     * @param text Input text
+     * @param position Index of the first byte to read, updated to the first byte after
+     *                 the paragraph and its blank line
+     */
+    void read(const string &text, size_t &position)
+    {
+        const char *data = text.data();
+        size_t end = text.size();
+        size_t i = position;
+        
+        // Does the current line have no words, so far?
+        bool empty = true;
+        
+        while(i < end)
+        {
+            if(data[i] == '\n')
+            {
+                ++i;
+                
+                if(empty)
+                    break;
+                
+                empty = true;
+            }
+            else if(isSeparator(data[i]))
+                ++i;
+            else
+            {
+                int width;
+                size_t start = i;
+                i = scanWord(data, start, end, width);
+                
+                words.push_back(string(data + start, i - start));
+                wordWidths.push_back(width);
+                STAT_ADD(words, 1);
+                empty = false;
+            }
+        }
+        
+        position = i;
+        
+        // Paragraph consists in only one line by default
+        // Every word is in the same line of the first word
+        lines = vector<int>(words.size(), 0);
+        
+        // No gap, so far
+        gap = words.size();
+    }
+    
+    /**
+     * Tells whether the paragraph is empty or not.
+     * @return True if the paragraph does not have any word, false otherwise
+     */
+    bool empty()
+    {
+        return size() < 1;
+    }
+    
+    /**
+     * @return Number of words of the paragraph
+     */
+    int size()
+    {
+        return words.size() - gapSize;
+    }
+    
+    /**
+     * Formats the words of the paragraphs in lines optimally (lowest penalty).
+     * Detailed information: https://www.jutge.org/problems/X57785_es/statement
+     * 
+     * Every optimum arrangement can be described recursively:
+     * If n = 1, the optimum arrangement is a line with the word itself.
+     * If n > 1, there exists k: 0 <= k < n, such that the optimum arrangement is:
+     * optimumArrangement(k)
+     * words[k+1..n]
      * 
      * Thus, we can find the optimum arrangement for n words recursively:
      * 1. Find the optimum arrangement for k words, for every k: 0 <= k < n.
@@ -191,20 +1442,22 @@ public:
      * @param width Target line width
      * @return The penalty/cost of arranging the words[0..n-1] optimally
      */
-    int wordwrap(int width)
+    long long wordwrap(int width)
     {
+        targetWidth = width;
+        
         // First, compute the line widths
         computeLineWidths();
         
         // Initialize optimal costs
-        optimalCosts = vector<int>(words.size());
+        optimalCosts = vector<long long>(words.size());
         
         // Given 0 <= j < words.size()
         // Calculate the optimal cost of arranging the words[0..j]
         for(int j = 0; j < words.size(); ++j)
         {
             // Set default minimum cost and index
-            int min_cost = cost(0, j, width);
+            long long min_cost = cost(0, j, width);
             int min_index = 0;
             
             // First iteration can be skipped because the default
@@ -220,19 +1473,10 @@ public:
             //    having the words[k..j] on its own line, for every 1 <= k <= i
             // 2. min_index = index of the word that should start the line that produces
             //    min_cost
-            for(int i = 1; i <= j; ++i)
-            {
-                // Cost of adding the line with words[i..j] to the optimum arrangement
-                // of words[0..i-1]
-                int new_cost = optimalCosts[i-1] + cost(i, j, width);
-                
-                // If necessary, update minimum cost and index to fulfill invariant
-                if(new_cost < min_cost)
-                {
-                    min_cost = new_cost;
-                    min_index = i;
-                }
-            }
+            // The candidates are evaluated in blocks by the bestLine() kernel, which
+            // preserves these invariants (see its description).
+            const long long *row = optimalCosts.data();
+            bestLine<LinePenalty, 1>(j, &width, &row, &min_cost, &min_index);
             
             // Note that we only update the min_index if the cost of adding the new line is
             // strictly less than the min_cost. This guarantees that if there is more than one
@@ -251,6 +1495,113 @@ public:
         return optimalCosts[words.size() - 1];
     }
     
+    /**
+     * Same as wordwrap(width), but using several threads for a single paragraph.
+     * The dynamic programming is solved with parallelWordwrap(), which exploits that the
+     * optimal line starts are monotone, and the rows of every step are split across threads.
+     * The lines and the penalty are the same as the ones of wordwrap(width).
+     * 
+     * Cost: O(n * log^2(n)) work, instead of O(n^2)
+     * 
+     * @param width Target line width
+     * @param threads Number of threads
+     * @return The penalty/cost of arranging the words[0..n-1] optimally
+     */
+    long long wordwrap(int width, int threads)
+    {
+        targetWidth = width;
+        
+        computeLineWidths();
+        
+        int n = words.size();
+        
+        // Shifted by one: costs[t] = optimalCosts[t-1] and costs[0] is the empty arrangement
+        vector<long long> costs(n + 1);
+        vector<long long> best(n + 1, LLONG_MAX);
+        vector<int> bestStart(n + 1, 0);
+        
+        best[0] = 0;
+        
+        parallelWordwrap(costs, best, bestStart, 0, n, width, threads);
+        
+        optimalCosts = vector<long long>(costs.begin() + 1, costs.end());
+        lines = vector<int>(bestStart.begin() + 1, bestStart.end());
+        
+        return optimalCosts[n - 1];
+    }
+    
+    /**
+     * Formats the words of the paragraph optimally for several target widths at once.
+     * It is the same dynamic programming of wordwrap(width), but the tokenization and the
+     * lineWidths prefix array are shared, and the widths are solved in groups of up to
+     * WIDTH_GROUP by the same bestLine() scan: every lineWidths[i-1] is loaded once per
+     * group and evaluated against the contiguous cost rows of its widths.
+     * 
+     * Cost:
+     * computeLineWidths() + main loop = O(n) + O(n^2 * k) = O(n^2 * k)
+     * 
+     * @param targets Target line widths
+     * @return The penalty of the optimal arrangement for every target width, in the same order
+     */
+    vector<long long> wordwrap(const vector<int> &targets)
+    {
+        const int WIDTH_GROUP = 4;
+        
+        widths = targets;
+        
+        computeLineWidths();
+        
+        int n = words.size();
+        int k = widths.size();
+        
+        widthCosts = vector<long long>((long long) n * k);
+        widthLines = vector<int>((long long) n * k);
+        
+        for(int j = 0; j < n; ++j)
+        {
+            for(int w = 0; w < k; w += WIDTH_GROUP)
+            {
+                int g = min(WIDTH_GROUP, k - w);
+                
+                const long long *rows[WIDTH_GROUP];
+                long long min_cost[WIDTH_GROUP];
+                int min_index[WIDTH_GROUP];
+                
+                // Default minimum: words[0..j] on the same line, for every width
+                for(int t = 0; t < g; ++t)
+                {
+                    rows[t] = &widthCosts[(long long) (w + t) * n];
+                    min_cost[t] = LinePenalty::apply(lineWidths[j] - widths[w + t]);
+                    min_index[t] = 0;
+                }
+                
+                // Same invariants as wordwrap(width), for every width independently
+                const int *group = &widths[w];
+                
+                switch(g)
+                {
+                    case 1: bestLine<LinePenalty, 1>(j, group, rows, min_cost, min_index); break;
+                    case 2: bestLine<LinePenalty, 2>(j, group, rows, min_cost, min_index); break;
+                    case 3: bestLine<LinePenalty, 3>(j, group, rows, min_cost, min_index); break;
+                    default: bestLine<LinePenalty, 4>(j, group, rows, min_cost, min_index);
+                }
+                
+                for(int t = 0; t < g; ++t)
+                {
+                    widthCosts[(long long) (w + t) * n + j] = min_cost[t];
+                    widthLines[(long long) (w + t) * n + j] = min_index[t];
+                }
+            }
+        }
+        
+        vector<long long> penalties(k);
+        
+        for(int w = 0; w < k; ++w)
+            penalties[w] = widthCosts[(long long) w * n + n - 1];
+        
+        return penalties;
+    }
+    
     /**
      * Prints the paragraph in the default output stream.
      * 
@@ -259,45 +1610,716 @@ public:
      */
     void print()
     {
-        printLines(words.size() - 1);
+        printLines(size() - 1);
     }
-};
-
-/**
- * Reads a target line width and paragraphs from the default input stream.
- * Prints every read paragraph optimally formatted and its penalty.
- * 
- * Solution to the problem: https://www.jutge.org/problems/X57785_es/statement
- * @return Execution status
- */
-int main()
-{
-    // Read target line width
-    int width;
-    cin >> width;
-    
-    // First paragraph?
-    bool first = true;
     
-    // While not end of file/input reached
-    while(!cin.eof())
+    /**
+     * Prints the paragraph arranged for widths[w] of the last multi-width wordwrap.
+     * 
+     * Cost:
+     * Copy of the arrangement + printLines(n) = O(n) + O(n) = O(n)
+     * 
+     * @param w Index of the target width
+     */
+    void print(int w)
     {
-        // Read a new paragraph
-        Paragraph p;
-        p.read();
+        int n = words.size();
         
-        if(not p.empty())
-        {
-            // Wordwrap paragraph and get penalty
-            int penalty = p.wordwrap(width);
+        copy(widthLines.begin() + (long long) w * n, widthLines.begin() + (long long) (w + 1) * n,
+                lines.begin());
+        
+        printLines(words.size() - 1);
+    }
+    
+    /**
+     * Inserts a word before words[position] and updates the arrangement of the last
+     * wordwrap(width) without recomputing it from scratch. See edit() for its cost.
+     * @param position Index of the new word, 0 <= position <= n
+     * @param word Word to insert
+     * @return The penalty of the new optimal arrangement
+     */
+    long long insertWord(int position, const string &word)
+    {
+        return edit(position, 0, vector<string>(1, word));
+    }
+    
+    /**
+     * Removes words[position] and updates the arrangement of the last wordwrap(width)
+     * without recomputing it from scratch. See edit() for its cost.
+     * @param position Index of the word to remove, 0 <= position < n
+     * @return The penalty of the new optimal arrangement
+     */
+    long long eraseWord(int position)
+    {
+        return edit(position, 1, vector<string>());
+    }
+    
+    /**
+     * Replaces words[position] and updates the arrangement of the last wordwrap(width)
+     * without recomputing it from scratch. See edit() for its cost.
+     * @param position Index of the word to replace, 0 <= position < n
+     * @param word New word
+     * @return The penalty of the new optimal arrangement
+     */
+    long long replaceWord(int position, const string &word)
+    {
+        return edit(position, 1, vector<string>(1, word));
+    }
+};
+
+/**
+ * Temporary file of unsigned integers, written forward and read backward.
+ * Every number is stored in LEB128: 7 bits per byte, from the least significant ones, and
+ * the high bit set in every byte but the last one. Small numbers take a single byte and,
+ * since the last byte of every number is the only one with the high bit clear, the
+ * stream can also be decoded from its end.
+ */
+class NumberStream
+{
+    /**
+     * Size of the blocks read from the end of the file.
+     */
+    static const int BLOCK = 1 << 16;
+    
+    FILE *file;
+    
+    /**
+     * Numbers written since the last clear() or read().
+     */
+    long size;
+    
+    /**
+     * Block being read backward: block[0..next-1] are the bytes not read yet and
+     * block[0] is at offset position of the file.
+     */
+    vector<unsigned char> block;
+    long position;
+    int next;
+    
+    /**
+     * Makes block[next-1] the previous byte not read yet, loading the previous block of
+     * the file when the current one is exhausted.
+     * @return False if every written byte has already been read
+     */
+    bool load()
+    {
+        if(next > 0)
+            return true;
+        
+        if(position == 0)
+            return false;
+        
+        next = min((long) BLOCK, position);
+        position -= next;
+        
+        fseek(file, position, SEEK_SET);
+        
+        if(fread(block.data(), 1, next, file) != next)
+        {
+            perror("NumberStream");
+            exit(1);
+        }
+        
+        return true;
+    }
+    
+public:
+    NumberStream() : file(tmpfile()), size(0), block(BLOCK), position(0), next(0)
+    {
+        if(file == NULL)
+        {
+            perror("NumberStream");
+            exit(1);
+        }
+    }
+    
+    ~NumberStream()
+    {
+        fclose(file);
+    }
+    
+    /**
+     * Discards the written numbers.
+     */
+    void clear()
+    {
+        rewind(file);
+        size = 0;
+        position = 0;
+        next = 0;
+    }
+    
+    /**
+     * Appends a number at the end of the stream.
+     * Cost: O(log(value))
+     * @param value Number to write
+     */
+    void write(uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            putc((value & 0x7F) | 0x80, file);
+            value >>= 7;
+        }
+        
+        putc(value, file);
+        ++size;
+    }
+    
+    /**
+     * Reads the written numbers from the last one to the first one.
+     * The first call after some write() starts again from the end of the stream.
+     * Cost: O(log(value)), plus reading a block every BLOCK bytes
+     * @param value Destination of the previous number
+     * @return False if every written number has already been read
+     */
+    bool read(uint64_t &value)
+    {
+        if(size > 0)
+        {
+            // Switch from writing to reading
+            fflush(file);
+            position = ftell(file);
+            next = 0;
+            size = 0;
+        }
+        
+        if(not load())
+            return false;
+        
+        // Last byte of the number, then the previous ones while their high bit is set
+        value = block[--next];
+        
+        while(load() and (block[next-1] & 0x80))
+            value = (value << 7) | (block[--next] & 0x7F);
+        
+        return true;
+    }
+};
+
+/**
+ * Paragraph formatted with memory bounded by the window of its dynamic programming,
+ * instead of by its number of words.
+ * 
+ * The words are spooled to a temporary file while they are read, and they are only kept
+ * there. wordwrap(width) streams them once, keeping the costs and line widths of the
+ * candidates that dominated() does not discard yet, and checkpoints the decision of every
+ * word (how many words precede it in its line) into a NumberStream. Then, the decisions are
+ * read backward to find the number of words of every line, and print() streams the words
+ * again to write the lines. The arrangement and the penalty are the ones of
+ * Paragraph::wordwrap(width), ties included.
+ * 
+ * Memory: O(d + longest word), where d is the number of candidates alive, which depends
+ * on the target width and not on n. The spool and the streams take O(n) bytes on disk.
+ */
+class StreamedParagraph
+{
+    /**
+     * Words of the paragraph, separated by a space.
+     * From now on:
+     * n = number of words
+     */
+    FILE *spool;
+    long long n;
+    
+    /**
+     * Number of words of every line of the last arrangement, from the last line to the
+     * first one, so they are read in order.
+     */
+    NumberStream lines;
+    
+    /**
+     * Optimal cost and line width of the words before a candidate line start.
+     */
+    struct Candidate
+    {
+        long long cost;
+        long long width;
+    };
+    
+    /**
+     * Reads the next word of the spool.
+     * @param word Destination of the word
+     * @return False if every word has been read
+     */
+    bool nextWord(string &word)
+    {
+        word.clear();
+        
+        int c;
+        
+        while((c = getc(spool)) != EOF and c != ' ')
+            word += c;
+        
+        return not word.empty();
+    }
+    
+public:
+    StreamedParagraph() : spool(tmpfile()), n(0)
+    {
+        if(spool == NULL)
+        {
+            perror("StreamedParagraph");
+            exit(1);
+        }
+    }
+    
+    ~StreamedParagraph()
+    {
+        fclose(spool);
+    }
+    
+    /**
+     * Reads a paragraph from the default input stream, until a blank line is read, with
+     * the same tokenization of Paragraph::read(). The input is read byte by byte, so a
+     * paragraph written in a single line is not kept in memory either.
+     *
+     * Cost: O(n), where n is the number of bytes read
+     */
+    void read()
+    {
+        streambuf *in = cin.rdbuf();
+        string word;
+        bool empty = true;
+        
+        while(true)
+        {
+            int c = in->sbumpc();
+            
+            if(c != EOF and not isSeparator(c))
+            {
+                word += c;
+                continue;
+            }
+            
+            if(not word.empty())
+            {
+                fwrite(word.data(), 1, word.size(), spool);
+                putc(' ', spool);
+                word.clear();
+                
+                ++n;
+                STAT_ADD(words, 1);
+                empty = false;
+            }
+            
+            if(c == EOF)
+            {
+                cin.setstate(ios::eofbit);
+                break;
+            }
+            
+            if(c == '\n')
+            {
+                if(empty)
+                    break;
+                
+                empty = true;
+            }
+        }
+    }
+    
+    /**
+     * Tells whether the paragraph is empty or not.
+     * @return True if the paragraph does not have any word, false otherwise
+     */
+    bool empty()
+    {
+        return n < 1;
+    }
+    
+    /**
+     * Same dynamic programming of Paragraph::wordwrap(width), over the candidates that
+     * are still alive. window[t] is the candidate line start words[alive + t]; lines that
+     * start before words[alive] are dominated, as in Paragraph::edit(), and they are
+     * dropped from the front of the window.
+     * 
+     * Cost:
+     * O(n * d) time and O(d) memory, plus the two passes over the decisions on disk
+     * 
+     * @param width Target line width
+     * @return The penalty/cost of arranging the words[0..n-1] optimally
+     */
+    long long wordwrap(int width)
+    {
+        long long target = width;
+        NumberStream decisions;
+        
+        deque<Candidate> window;
+        long long alive = 0;
+        
+        // Line width of words[0..j]; the empty arrangement has width -1
+        long long last = -1;
+        long long min_cost = 0;
+        
+        window.push_back({ 0, -1 });
+        rewind(spool);
+        
+        string word;
+        
+        for(long long j = 0; nextWord(word); ++j)
+        {
+            int wordWidth;
+            scanWord(word.data(), 0, word.size(), wordWidth);
+            last += wordWidth + 1;
+            
+            // Strictly less keeps the tie-break of wordwrap(width): the first alive
+            // candidate is the smallest index not dominated
+            int min_index = 0;
+            
+            for(int t = 0; t < window.size(); ++t)
+            {
+                long long new_cost = window[t].cost +
+                        LinePenalty::apply(last - window[t].width - 1 - target);
+                
+                if(t == 0 or new_cost < min_cost)
+                {
+                    min_cost = new_cost;
+                    min_index = t;
+                }
+            }
+            
+            STAT_ADD(candidates, window.size());
+            
+            // Checkpoint: number of words before words[j] in its line
+            decisions.write(j - alive - min_index);
+            
+            while(not window.empty() and Paragraph::dominated(window.front().cost,
+                    window.front().width, min_cost, last, target))
+            {
+                window.pop_front();
+                ++alive;
+            }
+            
+            window.push_back({ min_cost, last });
+        }
+        
+        // Backtrack from the last word: every line ends right before the start of the next
+        lines.clear();
+        
+        long long end = n - 1;
+        uint64_t before;
+        
+        for(long long j = n - 1; decisions.read(before); --j)
+        {
+            if(j == end)
+            {
+                lines.write(before + 1);
+                end = j - before - 1;
+            }
+        }
+        
+        return min_cost;
+    }
+    
+    /**
+     * Prints the paragraph arranged by the last wordwrap(width) in the default output stream.
+     * 
+     * Cost: O(n)
+     */
+    void print()
+    {
+        rewind(spool);
+        
+        string word;
+        uint64_t count;
+        
+        while(lines.read(count))
+        {
+            for(uint64_t k = 0; k < count; ++k)
+            {
+                nextWord(word);
+                
+                if(k > 0)
+                    cout << ' ';
+                
+                cout << word;
+            }
+            
+            cout << '\n';
+        }
+    }
+};
+
+/**
+ * Reads the rest of the default input stream.
+ * 
+ * Cost: O(b), where b is the number of bytes read
+ * 
+ * @return The bytes read
+ */
+string readInput()
+{
+    string text;
+    char buffer[1 << 16];
+    
+    while(cin.read(buffer, sizeof(buffer)) or cin.gcount() > 0)
+        text.append(buffer, cin.gcount());
+    
+    return text;
+}
+
+/**
+ * Reads a line of the input text, as getline() does.
+ * 
+ * Cost: O(length of the line)
+ * 
+ * @param text Input text
+ * @param position Index of the first byte of the line, updated to the next line
+ * @param line Destination of the line, without its line break
+ * @return False if the text has no more lines
+ */
+bool readLine(const string &text, size_t &position, string &line)
+{
+    if(position >= text.size())
+        return false;
+    
+    size_t end = text.find('\n', position);
+    
+    if(end == string::npos)
+        end = text.size();
+    
+    line.assign(text, position, end - position);
+    position = min(end + 1, text.size());
+    
+    return true;
+}
+
+/**
+ * Reads a block of edits of the paragraph from the input text, until a blank line, and
+ * prints the paragraph and its penalty after every edit.
+ * Invalid edits (unknown, out of range, or erasing the last word) are reported and skipped.
+ * 
+ * Cost: the one of Paragraph::edit() plus O(n) to print the paragraph, for every edit
+ * 
+ * @param p Paragraph arranged by wordwrap(width)
+ * @param text Input text
+ * @param position Index of the first byte of the edits, updated to the first byte after
+ *                 the block
+ */
+void edit(Paragraph &p, const string &text, size_t &position)
+{
+    string line;
+    
+    while(readLine(text, position, line))
+    {
+        istringstream in(line);
+        string command, word;
+        int position;
+        
+        if(not (in >> command))
+            break;
+        
+        int n = p.size();
+        bool valid = bool(in >> position) and position >= 1;
+        
+        if(command == "+")
+            valid = valid and position <= n + 1 and bool(in >> word);
+        else if(command == "-")
+            valid = valid and position <= n and n > 1;
+        else if(command == "=")
+            valid = valid and position <= n and bool(in >> word);
+        else
+            valid = false;
+        
+        if(not valid)
+        {
+            cout << endl << "Edición inválida: " << line << endl;
+            continue;
+        }
+        
+        long long penalty;
+        
+        {
+            STAT_PHASE(edit);
+            
+            if(command == "+")
+                penalty = p.insertWord(position - 1, word);
+            else if(command == "-")
+                penalty = p.eraseWord(position - 1);
+            else
+                penalty = p.replaceWord(position - 1, word);
+        }
+        
+        STAT_PHASE(print);
+        
+        cout << endl;
+        p.print();
+        cout << "Penalty: " << penalty << endl;
+    }
+}
+
+/**
+ * Reads target line widths and paragraphs from the default input stream.
+ * Prints every read paragraph optimally formatted and its penalty.
+ * 
+ * The first line contains the target line widths. If it only contains one width, the
+ * output is the one of the original problem. If it contains several widths, every
+ * paragraph is arranged for all of them in a single pass and each arrangement is
+ * preceded by a "Width: w" line.
+ * 
+ * Options:
+ *   --threads t  Arranges every paragraph with wordwrap(width, t) using t threads
+ *   --stream     Arranges every paragraph with a StreamedParagraph, whose memory does not
+ *                grow with its length. Several widths are arranged one after another.
+ *   --edit       Only with a single width and without --stream (otherwise it is rejected with
+ *                an error). Every paragraph is followed by a block of edits, one per line,
+ *                until a blank line: "+ i w" inserts w before the i-th word
+ *                (numbered from 1), "- i" erases the i-th word and "= i w" replaces it by w.
+ *                The paragraph is printed after the first arrangement and after every edit,
+ *                which updates it with Paragraph::edit() instead of arranging it again.
+ * 
+ * Solution to the problem: https://www.jutge.org/problems/X57785_es/statement
+ * @param argc Number of arguments
+ * @param argv Arguments
+ * @return Execution status
+ */
+int main(int argc, char *argv[])
+{
+    int threads = 1;
+    bool stream = false;
+    bool edits = false;
+    
+    for(int i = 1; i < argc; ++i)
+    {
+        string option = argv[i];
+        
+        if(option == "--threads" and i + 1 < argc)
+            threads = atoi(argv[++i]);
+        else if(option == "--stream")
+            stream = true;
+        else if(option == "--edit")
+            edits = true;
+    }
+    
+    // Read target line widths
+    vector<int> widths;
+    
+    string header;
+    getline(cin, header);
+    
+    istringstream targets(header);
+    int width;
+    
+    while(targets >> width)
+        widths.push_back(width);
+    
+    // Edits update a single arrangement kept in memory
+    if(edits and (widths.size() != 1 or stream))
+    {
+        cerr << "Error: --edit necesita un único ancho de línea y no admite --stream" << endl;
+        return 1;
+    }
+    
+    // The rest of the input is read at once and tokenized in place, except when streaming
+    string input;
+    size_t position = 0;
+    
+    if(not stream)
+    {
+        STAT_PHASE(read);
+        input = readInput();
+    }
+    
+    // First paragraph?
+    bool first = true;
+    
+    // While not end of file/input reached
+    while(stream ? !cin.eof() : position < input.size())
+    {
+        if(stream)
+        {
+            StreamedParagraph p;
+            
+            {
+                STAT_PHASE(read);
+                p.read();
+            }
+            
+            if(p.empty())
+                continue;
+            
+            STAT_ADD(paragraphs, 1);
+            
+            for(int w = 0; w < widths.size(); ++w)
+            {
+                long long penalty;
+                
+                {
+                    STAT_PHASE(wordwrap);
+                    penalty = p.wordwrap(widths[w]);
+                }
+                
+                if(first) first = false;
+                else cout << endl;
+                
+                if(widths.size() > 1)
+                    cout << "Width: " << widths[w] << endl;
+                
+                STAT_PHASE(print);
+                p.print();
+                cout << "Penalty: " << penalty << endl;
+            }
+            
+            continue;
+        }
+        
+        // Read a new paragraph
+        Paragraph p;
+        
+        {
+            STAT_PHASE(read);
+            p.read(input, position);
+        }
+        
+        if(p.empty())
+            continue;
+        
+        STAT_ADD(paragraphs, 1);
+        
+        if(widths.size() == 1)
+        {
+            // Wordwrap paragraph and get penalty
+            long long penalty;
+            
+            {
+                STAT_PHASE(wordwrap);
+                penalty = threads > 1 ? p.wordwrap(widths[0], threads) : p.wordwrap(widths[0]);
+            }
             
             // Print separator, if necessary
             if(first) first = false;
             else cout << endl;
             
             // Print paragraph and penalty
+            STAT_PHASE(print);
             p.print();
             cout << "Penalty: " << penalty << endl;
+            
+            if(edits)
+                edit(p, input, position);
+        }
+        else
+        {
+            // Wordwrap paragraph for every width sharing the same tokenization
+            vector<long long> penalties;
+            
+            {
+                STAT_PHASE(wordwrap);
+                penalties = p.wordwrap(widths);
+            }
+            
+            STAT_PHASE(print);
+            
+            for(int w = 0; w < widths.size(); ++w)
+            {
+                if(first) first = false;
+                else cout << endl;
+                
+                cout << "Width: " << widths[w] << endl;
+                p.print(w);
+                cout << "Penalty: " << penalties[w] << endl;
+            }
         }
     }
     
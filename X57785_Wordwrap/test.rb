@@ -0,0 +1,119 @@
+require 'fileutils'
+require 'colorize'
+
+# Number of words of the random paragraphs
+SIZES = [ 10, 100, 1000, 5000 ]
+
+# Paragraphs and edits of every size
+PARAGRAPHS = 5
+EDITS = 200
+
+# Generates a random word, with a few long ones and some UTF-8
+def rand_word
+  length = rand(10) == 0 ? rand(30) + 1 : rand(8) + 1
+
+  Array.new(length) { [ "a", "b", "c", "d", "é", "ñ", "日" ].sample }.join
+end
+
+# Tests the --edit mode: every edit updates the arrangement incrementally, and it must be
+# the same arrangement (and penalty) of formatting the edited paragraph from scratch
+class EditTest
+  def initialize(size)
+    @size = size
+  end
+
+  def generate
+    width = rand(60) + 5
+
+    input = [ width.to_s ]
+    states = []
+
+    PARAGRAPHS.times do
+      words = Array.new(@size) { rand_word }
+      edits = []
+      last = 1
+
+      input << words.join(" ") << ""
+      states << words.join(" ")
+
+      EDITS.times do
+        # Half of the edits are close to the previous one
+        i = rand(2) == 0 ? last + rand(5) - 2 : rand(words.size) + 1
+        i = [ [ i, 1 ].max, words.size ].min
+        last = i
+
+        case rand(3)
+        when 0
+          i = words.size + 1 if rand(20) == 0
+          word = rand_word
+          edits << "+ #{i} #{word}"
+          words.insert(i - 1, word)
+        when 1
+          next if words.size < 2
+          edits << "- #{i}"
+          words.delete_at(i - 1)
+        else
+          word = rand_word
+          edits << "= #{i} #{word}"
+          words[i - 1] = word
+        end
+
+        states << words.join(" ")
+      end
+
+      input << edits.join("\n") << ""
+    end
+
+    File.open("test_#{@size}.dat", "w") { |f| f.write(input.join("\n")) }
+
+    # Every state as its own paragraph, formatted from scratch
+    File.open("test_#{@size}_full.dat", "w") do |f|
+      f.write("#{width}\n#{states.join("\n\n")}\n")
+    end
+
+    system("./test < test_#{@size}_full.dat > test_#{@size}.out")
+  end
+
+  def perform
+    print "Testing #{@size} words with #{EDITS} edits... ".yellow
+
+    generate
+
+    beginning_time = Time.now
+    execution = system("./test --edit < test_#{@size}.dat > test_#{@size}_exec.out")
+    end_time = Time.now
+
+    unless execution
+      puts "Failed".red
+      exit(1)
+    end
+
+    if FileUtils.cmp("test_#{@size}.out", "test_#{@size}_exec.out")
+      print "Passed".green
+      print " "
+      puts "#{(end_time - beginning_time)*1000} ms".blue
+    else
+      puts "Wrong".red
+      exit(1)
+    end
+
+    File.delete("test_#{@size}.dat")
+    File.delete("test_#{@size}_full.dat")
+    File.delete("test_#{@size}.out")
+    File.delete("test_#{@size}_exec.out")
+  end
+end
+
+puts "Compiling main.cc...".blue
+compiled = system("make -s -B test")
+
+unless compiled
+  puts "Compilation failed.".red
+  exit(1)
+end
+
+SIZES.each do |size|
+  EditTest.new(size).perform
+end
+
+File.delete("test")
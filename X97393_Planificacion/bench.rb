@@ -0,0 +1,163 @@
+require 'fileutils'
+require 'json'
+require 'colorize'
+
+# Sizes of the random projects
+SIZES = [ 10**4, 10**5, 10**6 ]
+
+# Maximum number of childs of a task and maximum distance between a task and its childs
+# in the generated topological order
+CHILDS = 3
+SPAN = 1000
+
+# Number of tasks of every layer of the layered projects
+WIDTH = 50
+
+# Number of scenarios of the simulations
+SCENARIOS = 64
+
+# Number of random pairs of tasks queried to the longest path index
+QUERIES = 100
+
+# Writes the tasks of a project, given the childs of every task in topological order, with
+# random ids, random uncertain durations and in random order
+def write_project(childs)
+  ids = (0...childs.size).to_a.shuffle
+
+  records = childs.each_with_index.map do |task_childs, i|
+    likely = rand(9) + 1
+    duration = "#{[ likely - rand(3), 1 ].max},#{likely},#{likely + rand(6)}"
+
+    "T#{ids[i]} #{duration} #{task_childs.map { |c| "T#{ids[c]}" }.join(" ")} @"
+  end
+
+  records.shuffle!
+
+  "#{childs.size}\n#{records.join("\n")}\n"
+end
+
+# Generates a random acyclic project of size tasks.
+# Tasks are created in a random topological order, but they are written with random ids
+# and in random order, so the indexes given by read() have no relation with the order the
+# planner visits them.
+def rand_project(size)
+  childs = Array.new(size) do |i|
+    Array.new(rand(CHILDS + 1)) { i + 1 + rand(SPAN) }.select { |c| c < size }.uniq
+  end
+
+  write_project(childs)
+end
+
+# Generates a random layered project of size tasks: layers of WIDTH tasks, where every task
+# has up to CHILDS prerequisites in the previous layer. Every path between two layers goes
+# through all the layers between them.
+def rand_layered(size)
+  childs = Array.new(size) { [] }
+
+  (WIDTH...size).each do |i|
+    layer = i / WIDTH * WIDTH - WIDTH
+
+    Array.new(rand(CHILDS) + 1) { layer + rand(WIDTH) }.uniq.each { |p| childs[p] << i }
+  end
+
+  write_project(childs)
+end
+
+class Bench
+  def initialize(size)
+    @size = size
+  end
+
+  # Runs the instrumented planner, writing its output to bench_SIZE_name.out and returning
+  # its statistics (and cache misses, when perf is available)
+  def run(name, options, input = "bench_#{@size}.dat")
+    command = "./instrument #{options} < #{input} > bench_#{@size}_#{name}.out"
+    stats = "bench_#{@size}_#{name}.json"
+
+    unless system("#{command} 2> #{stats}")
+      puts "Failed".red
+      exit(1)
+    end
+
+    result = JSON.parse(File.read(stats))
+    File.delete(stats)
+
+    if PERF
+      perf = `perf stat -x, -e cache-misses sh -c '#{command}' 2>&1`
+      result["cache_misses"] = perf.lines.last.split(",").first.to_i
+    end
+
+    result
+  end
+
+  def report(name, stats)
+    print "  #{name.ljust(12)}"
+    print "renumber #{stats["renumber_ms"].round(1)} ms, "
+    print "simulate #{stats["simulate_ms"].round(1)} ms"
+    print ", #{stats["cache_misses"]} cache misses" if stats["cache_misses"]
+    puts
+  end
+
+  # Builds the longest path index of a project and answers random pairs of tasks
+  def query(name, project)
+    File.open("bench_#{@size}_query.dat", "w") do |f|
+      f.write(project)
+      QUERIES.times { f.puts("T#{rand(@size)} T#{rand(@size)}") }
+    end
+
+    index = run("query", "--query", "bench_#{@size}_query.dat")
+
+    print "  #{(name + " index").ljust(14)}"
+    print "build #{index["index_ms"].round(1)} ms, "
+    print "#{(index["index_bytes"] / 2.0**20).round(1)} MiB, "
+    print "#{(index["query_ms"] / QUERIES).round(4)} ms/query, "
+    puts "#{index["query_labels"] / QUERIES} labels/query"
+
+    File.delete("bench_#{@size}_query.dat")
+    File.delete("bench_#{@size}_query.out")
+  end
+
+  def perform
+    puts "Planning #{@size} tasks...".yellow
+
+    File.open("bench_#{@size}.dat", "w") { |f| f.write(rand_project(@size)) }
+
+    plain = run("plain", "--simulate #{SCENARIOS}")
+    renumbered = run("renumber", "--simulate #{SCENARIOS} --renumber")
+
+    unless FileUtils.cmp("bench_#{@size}_plain.out", "bench_#{@size}_renumber.out")
+      puts "Wrong".red
+      exit(1)
+    end
+
+    report("read order", plain)
+    report("renumber", renumbered)
+
+    # The simulation phase includes the renumbering
+    speedup = plain["simulate_ms"] / [ renumbered["simulate_ms"], 0.001 ].max
+    puts "  #{SCENARIOS} scenarios #{speedup.round(2)}x faster".blue
+
+    query("random", File.read("bench_#{@size}.dat"))
+    query("layered", rand_layered(@size))
+
+    File.delete("bench_#{@size}.dat")
+    File.delete("bench_#{@size}_plain.out")
+    File.delete("bench_#{@size}_renumber.out")
+  end
+end
+
+PERF = system("perf stat -e cache-misses true > /dev/null 2>&1")
+
+puts "Compiling main.cc...".blue
+compiled = system("make -s -B instrument")
+
+unless compiled
+  puts "Compilation failed.".red
+  exit(1)
+end
+
+SIZES.each do |size|
+  Bench.new(size).perform
+end
+
+File.delete("instrument")
@@ -5,15 +5,580 @@
 #include <string>
 #include <queue>
 #include <list>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using namespace std;
 
+#ifdef INSTRUMENT
+#include <chrono>
+
+/**
+ * Counters of the planner, written as JSON to the standard error when the program exits.
+ * Only compiled with -DINSTRUMENT (make instrument); otherwise the STAT_* macros expand to
+ * nothing. They are updated by the coordinator thread/process only: worker threads of the
+ * simulation and of plan_batch() and worker processes of the shards are not instrumented.
+ */
+struct Statistics
+{
+    long long visited, relaxed, scenarios, rounds, messages, queries, query_labels, index_bytes;
+    long long projects;
+    size_t early_queue_max;
+    double read_ms, early_ms, renumber_ms, latest_ms, print_ms, simulate_ms, sharded_ms;
+    double index_ms, query_ms, batch_ms;
+    
+    ~Statistics()
+    {
+        fprintf(stderr, "{\"visited\": %lld, \"relaxed\": %lld, \"early_queue_max\": %zu, "
+                "\"scenarios\": %lld, \"rounds\": %lld, \"messages\": %lld, \"queries\": %lld, "
+                "\"query_labels\": %lld, \"index_bytes\": %lld, \"projects\": %lld, "
+                "\"read_ms\": %.3f, \"early_ms\": %.3f, \"renumber_ms\": %.3f, "
+                "\"latest_ms\": %.3f, \"print_ms\": %.3f, \"simulate_ms\": %.3f, "
+                "\"sharded_ms\": %.3f, \"index_ms\": %.3f, \"query_ms\": %.3f, "
+                "\"batch_ms\": %.3f}\n", visited, relaxed, early_queue_max, scenarios, rounds,
+                messages, queries, query_labels, index_bytes, projects, read_ms, early_ms,
+                renumber_ms, latest_ms, print_ms, simulate_ms, sharded_ms, index_ms, query_ms,
+                batch_ms);
+    }
+} statistics;
+
+/**
+ * Adds the time elapsed during its lifetime to a phase of the statistics.
+ */
+struct PhaseTimer
+{
+    double& total;
+    chrono::steady_clock::time_point start;
+    
+    PhaseTimer(double& total) : total(total), start(chrono::steady_clock::now())
+    { }
+    
+    ~PhaseTimer()
+    {
+        if(instrumented)
+            total += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    
+    /**
+     * False in the threads that do not update the statistics (see STAT_IGNORE).
+     */
+    static thread_local bool instrumented;
+};
+
+thread_local bool PhaseTimer::instrumented = true;
+
+#define STAT_ADD(counter, value) \
+    (PhaseTimer::instrumented ? (void) (statistics.counter += (value)) : (void) 0)
+#define STAT_MAX(counter, value) (PhaseTimer::instrumented ? \
+    (void) (statistics.counter = max(statistics.counter, (size_t) (value))) : (void) 0)
+#define STAT_PHASE(phase) PhaseTimer phase##_timer(statistics.phase##_ms)
+#define STAT_IGNORE() (PhaseTimer::instrumented = false)
+#else
+#define STAT_ADD(counter, value) ((void) 0)
+#define STAT_MAX(counter, value) ((void) 0)
+#define STAT_PHASE(phase)
+#define STAT_IGNORE() ((void) 0)
+#endif
+
+/**
+ * Part of the task graph of a project, owned by a worker process.
+ * The tasks of a project with t tasks (including START and END) are split among s shards
+ * in consecutive blocks of indexes: the task i is owned by the shard owner(i, t, s).
+ * 
+ * A shard only stores its tasks and the relations of its tasks. It receives batches of
+ * messages from the coordinator process through a local socket and answers every batch
+ * with a batch of messages. Every message has three integers: operation, a, b.
+ * Messages about a task that belongs to another shard are sent to the coordinator, which
+ * routes them to the owner of the task (field a) in the next round.
+ */
+class Shard
+{
+public:
+    /**
+     * Operations of the messages.
+     */
+    enum Operation
+    {
+        TASK,           // Task a has duration b
+        CHILD,          // Task a is prerequisite of task b
+        PREREQUISITE,   // Task b is prerequisite of task a
+        LINK,           // Relate START and END with the tasks, a is the END task
+        FORWARD,        // Start calculating the earliest times
+        RELAX,          // A prerequisite of task a ends at time b
+        REPORT,         // Report the visited tasks and the project length
+        BACKWARD,       // Start calculating the latest times, a is the project length
+        TIGHTEN,        // A child of task a starts at time b at most
+        COLLECT,        // Report the times of every task
+        QUIT,           // Finish the worker process
+        VISITED,        // Answer: a tasks have been visited
+        LENGTH,         // Answer: the project length is a
+        START_TIME,     // Answer: earliest start time of task a is b
+        END_TIME        // Answer: latest end time of task a is b
+    };
+    
+    /**
+     * Shard that owns the given task.
+     * @param task Index of a task
+     * @param tasks Number of tasks
+     * @param shards Number of shards
+     * @return Owner of the task
+     */
+    static int owner(int task, int tasks, int shards)
+    {
+        return (long long) task * shards / tasks;
+    }
+    
+    /**
+     * Writes a batch of messages to a socket.
+     * @param fd Socket
+     * @param batch Messages
+     */
+    static void send(int fd, const vector<int>& batch)
+    {
+        int size = batch.size();
+        
+        write_all(fd, (const char*) &size, sizeof(int));
+        write_all(fd, (const char*) batch.data(), size * sizeof(int));
+    }
+    
+    /**
+     * Reads a batch of messages from a socket.
+     * @param fd Socket
+     * @param batch Destination of the messages
+     */
+    static void receive(int fd, vector<int>& batch)
+    {
+        int size;
+        
+        read_all(fd, (char*) &size, sizeof(int));
+        batch.resize(size);
+        read_all(fd, (char*) batch.data(), size * sizeof(int));
+    }
+    
+    /**
+     * Reports a failed system call on the standard error and finishes the process with
+     * status 1. The sockets of the process get closed, so the failure is also noticed (and
+     * reported) by the processes at their other end.
+     * @param call Name of the failed call
+     */
+    static void fail(const char* call)
+    {
+        fprintf(stderr, "Error en %s: %s\n", call, errno != 0 ? strerror(errno) :
+                "socket cerrado");
+        _exit(1);
+    }
+    
+    /**
+     * Creates the shard number index of a project.
+     * @param index Index of the shard
+     * @param tasks Number of tasks of the project
+     * @param shards Number of shards
+     */
+    Shard(int index, int tasks, int shards) : index(index), total(tasks), shards(shards),
+        visited(0), phase(FORWARD)
+    {
+        // First task owned by the shard: smallest i such that i * shards / tasks >= index
+        first = ((long long) index * tasks + shards - 1) / shards;
+        
+        int end = ((long long) (index + 1) * tasks + shards - 1) / shards;
+        
+        duration.resize(end - first);
+        childs.resize(end - first);
+        prerequisites.resize(end - first);
+        count.resize(end - first);
+        min_start.resize(end - first, 0);
+        max_end.resize(end - first, 0);
+    }
+    
+    /**
+     * Answers the batches of the coordinator until a QUIT message is received.
+     * 
+     * Average cost:
+     * Every task of the shard is visited once per pass and every message is processed
+     * in constant time: O(ns + ms + r), where ns and ms are the tasks and relations of the
+     * shard and r is the number of messages received.
+     * 
+     * @param fd Socket connected to the coordinator
+     */
+    void run(int fd)
+    {
+        vector<int> batch;
+        
+        while(true)
+        {
+            receive(fd, batch);
+            outbox.clear();
+            
+            for(int i = 0; i < batch.size(); i += 3)
+            {
+                if(batch[i] == QUIT)
+                    return;
+                
+                process(batch[i], batch[i+1], batch[i+2]);
+            }
+            
+            // Visit every task that became ready
+            drain();
+            
+            send(fd, outbox);
+        }
+    }
+    
+private:
+    int index, total, shards;
+    
+    /**
+     * Index of the first task of the shard. The task i is stored at position i - first.
+     */
+    int first;
+    
+    /**
+     * Durations, relations and times of the tasks of the shard, like in Project::Task.
+     * Relations use the indexes of the project.
+     */
+    vector<int> duration;
+    vector< vector<int> > childs;
+    vector< vector<int> > prerequisites;
+    vector<int> min_start;
+    vector<int> max_end;
+    
+    /**
+     * Prerequisites (forward) or childs (backward) of every task not visited yet.
+     */
+    vector<int> count;
+    
+    /**
+     * Tasks of the shard whose count is 0 and have not been visited yet.
+     */
+    queue<int> pending;
+    
+    /**
+     * Number of tasks visited by the forward pass.
+     */
+    int visited;
+    
+    /**
+     * Current pass, FORWARD or BACKWARD.
+     */
+    int phase;
+    
+    /**
+     * Messages of the answer to the current batch.
+     */
+    vector<int> outbox;
+    
+    /**
+     * Writes size bytes to a socket. Finishes the process with an error if the socket is
+     * closed. Writing to a closed socket does not raise SIGPIPE.
+     * @param fd Socket
+     * @param data Bytes to write
+     * @param size Number of bytes
+     */
+    static void write_all(int fd, const char* data, size_t size)
+    {
+        while(size > 0)
+        {
+            errno = 0;
+            ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+            
+            if(written < 0 and errno == EINTR)
+                continue;
+            
+            if(written <= 0)
+                fail("write");
+            
+            data += written;
+            size -= written;
+        }
+    }
+    
+    /**
+     * Reads size bytes from a socket. Finishes the process with an error if the socket is
+     * closed.
+     * @param fd Socket
+     * @param data Destination of the bytes
+     * @param size Number of bytes
+     */
+    static void read_all(int fd, char* data, size_t size)
+    {
+        while(size > 0)
+        {
+            errno = 0;
+            ssize_t received = read(fd, data, size);
+            
+            if(received < 0 and errno == EINTR)
+                continue;
+            
+            if(received <= 0)
+                fail("read");
+            
+            data += received;
+            size -= received;
+        }
+    }
+    
+    /**
+     * Tells whether a task belongs to the shard.
+     * @param task Index of a task
+     * @return True if the task is stored in this shard
+     */
+    bool owns(int task)
+    {
+        return owner(task, total, shards) == index;
+    }
+    
+    /**
+     * Adds a message to the answer of the current batch.
+     * @param operation Operation
+     * @param a First field, the task the message is about
+     * @param b Second field
+     */
+    void message(int operation, int a, int b)
+    {
+        outbox.push_back(operation);
+        outbox.push_back(a);
+        outbox.push_back(b);
+    }
+    
+    /**
+     * Processes a message received by the shard. Messages generated by the shard about
+     * its own tasks are also processed here, instead of being sent to the coordinator.
+     * @param operation Operation
+     * @param a First field
+     * @param b Second field
+     */
+    void process(int operation, int a, int b)
+    {
+        int i = a - first;
+        
+        switch(operation)
+        {
+        case TASK:
+            duration[i] = b;
+            break;
+            
+        case CHILD:
+            childs[i].push_back(b);
+            break;
+            
+        case PREREQUISITE:
+            prerequisites[i].push_back(b);
+            break;
+            
+        case LINK:
+            // Same relations that Project::read() adds, a is the END task
+            for(int task = max(first, 1); task < first + (int) duration.size() and task < a; ++task)
+            {
+                if(prerequisites[task - first].empty())
+                    send_or_process(CHILD, 0, task, PREREQUISITE, task, 0);
+                
+                if(childs[task - first].empty())
+                    send_or_process(PREREQUISITE, a, task, CHILD, task, a);
+            }
+            break;
+            
+        case FORWARD:
+        case BACKWARD:
+            phase = operation;
+            
+            for(int k = 0; k < duration.size(); ++k)
+            {
+                count[k] = operation == FORWARD ? prerequisites[k].size() : childs[k].size();
+                
+                if(operation == BACKWARD)
+                    max_end[k] = a;
+                
+                // Like calculate_early_times(), the forward pass only starts from START:
+                // other tasks without prerequisites (END, in an empty project) are not
+                // visited, so that the cycle check gives the same answer
+                if(count[k] == 0 and (operation == BACKWARD or first + k == 0))
+                    pending.push(k);
+            }
+            break;
+            
+        case RELAX:
+            min_start[i] = max(min_start[i], b);
+            
+            if(--count[i] == 0)
+                pending.push(i);
+            break;
+            
+        case TIGHTEN:
+            max_end[i] = min(max_end[i], b);
+            
+            if(--count[i] == 0)
+                pending.push(i);
+            break;
+            
+        case REPORT:
+            message(VISITED, visited, 0);
+            
+            if(owns(total - 1))
+                message(LENGTH, min_start[total - 1 - first] + duration[total - 1 - first], 0);
+            break;
+            
+        case COLLECT:
+            for(int k = 0; k < duration.size(); ++k)
+            {
+                message(START_TIME, first + k, min_start[k]);
+                message(END_TIME, first + k, max_end[k]);
+            }
+            break;
+        }
+    }
+    
+    /**
+     * Relates a task of the shard with the START or END task (the task a of the first
+     * message): the first message is processed here or sent to the owner of a, and the
+     * second one, about a task of the shard, is processed here.
+     * @param operation Operation of the first message
+     * @param a First field of the first message
+     * @param b Second field of the first message
+     * @param local Operation of the second message
+     * @param c First field of the second message
+     * @param d Second field of the second message
+     */
+    void send_or_process(int operation, int a, int b, int local, int c, int d)
+    {
+        if(owns(a))
+            process(operation, a, b);
+        else
+            message(operation, a, b);
+        
+        process(local, c, d);
+    }
+    
+    /**
+     * Visits the pending tasks, like Project::calculate_early_times() (forward) or
+     * Project::calculate_latest_times() (backward) do, but relations with tasks of other
+     * shards are sent as RELAX or TIGHTEN messages.
+     */
+    void drain()
+    {
+        while(!pending.empty())
+        {
+            int k = pending.front();
+            pending.pop();
+            
+            if(phase == FORWARD)
+            {
+                ++visited;
+                
+                int min_end = min_start[k] + duration[k];
+                
+                for(int i = 0; i < childs[k].size(); ++i)
+                {
+                    if(owns(childs[k][i]))
+                        process(RELAX, childs[k][i], min_end);
+                    else
+                        message(RELAX, childs[k][i], min_end);
+                }
+            }
+            else
+            {
+                int max_start = max_end[k] - duration[k];
+                
+                for(int i = 0; i < prerequisites[k].size(); ++i)
+                {
+                    if(owns(prerequisites[k][i]))
+                        process(TIGHTEN, prerequisites[k][i], max_start);
+                    else
+                        message(TIGHTEN, prerequisites[k][i], max_start);
+                }
+            }
+        }
+    }
+};
+
+/**
+ * The whole standard input, in memory. A regular file is mapped instead of copied, any
+ * other input (like a pipe) is read into a buffer.
+ */
+class Input
+{
+public:
+    /**
+     * Characters of the input, from data[0] to data[size-1]. They are not followed by a
+     * null character.
+     */
+    const char* data;
+    size_t size;
+    
+    /**
+     * Loads the rest of the standard input.
+     * 
+     * Cost: O(1) when it is mapped, O(b) otherwise, where b is the size of the input
+     */
+    Input() : mapping(NULL), mapped(0)
+    {
+        int fd = fileno(stdin);
+        off_t offset = lseek(fd, 0, SEEK_CUR);
+        struct stat status;
+        
+        if(offset >= 0 and fstat(fd, &status) == 0 and S_ISREG(status.st_mode)
+                and status.st_size > offset)
+        {
+            mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            
+            if(mapping != MAP_FAILED)
+            {
+                mapped = status.st_size;
+                data = (const char*) mapping + offset;
+                size = mapped - offset;
+                return;
+            }
+            
+            mapping = NULL;
+        }
+        
+        char buffer[1 << 16];
+        size_t count;
+        
+        while((count = fread(buffer, 1, sizeof(buffer), stdin)) > 0)
+            text.append(buffer, count);
+        
+        data = text.data();
+        size = text.size();
+    }
+    
+    ~Input()
+    {
+        if(mapping != NULL)
+            munmap(mapping, mapped);
+    }
+    
+private:
+    string text;
+    void* mapping;
+    size_t mapped;
+    
+    Input(const Input&);
+    Input& operator=(const Input&);
+};
+
 /**
  * Represents a set of tasks with dependencies.
  */
 class Project
 {
     static string message_cycles() { return "Proyecto contiene ciclos"; }
+    static string message_duration(const string& token) { return "Duración inválida: " + token; }
     
     /**
      * Represents a task.
@@ -27,16 +592,25 @@ class Project
         
         /**
          * Time the task needs until completion.
+         * When the duration is uncertain, it is the most likely one.
          */
         int duration;
         
+        /**
+         * Minimum and maximum time the task may need until completion.
+         * Both are equal to duration when the duration is certain.
+         */
+        int optimistic, pessimistic;
+        
         /**
          * List of tasks from which the current task is prerequisite.
+         * Moved to the compressed relations by renumber() (see Project::childs()).
          */
         vector<int> childs;
         
         /**
          * List of tasks that are prerrequisite of the current task.
+         * Moved to the compressed relations by renumber() (see Project::prerequisites()).
          */
         vector<int> prerequisites;
         
@@ -50,8 +624,43 @@ class Project
          */
         int max_end;
         
-        Task() : duration(0), min_start(0), max_end(0)
+        Task() : duration(0), optimistic(0), pessimistic(0), min_start(0), max_end(0)
+        { }
+        
+        /**
+         * Resets the task as if it was just constructed, keeping the memory of its id and
+         * its relations.
+         */
+        void clear()
+        {
+            id.clear();
+            duration = optimistic = pessimistic = min_start = max_end = 0;
+            childs.clear();
+            prerequisites.clear();
+        }
+    };
+    
+    /**
+     * Relations of a task (see childs() and prerequisites()): a range of task indexes,
+     * either of a vector of the task or of the compressed relations built by renumber().
+     */
+    struct Relations
+    {
+        const int* first;
+        const int* last;
+        
+        Relations(const int* first, const int* last) : first(first), last(last)
         { }
+        
+        int size() const
+        {
+            return last - first;
+        }
+        
+        int operator[](int i) const
+        {
+            return first[i];
+        }
     };
     
     /**
@@ -60,130 +669,1250 @@ class Project
     vector<Task> tasks;
     
     /**
-     * Maps every task identifier with its index in the tasks vector.
+     * Tasks removed by clear(), reused by the next project read.
      */
-    unordered_map<string, int> indexes;
+    vector<Task> spare;
     
-public:
     /**
-     * Reads a project from the input stream.
-     * Each task gets reserved an index in the tasks vector in the order
-     * they are read.
-     * Each task gets related with its prerequisites and the tasks from which
-     * is prerequisite. This is, actually, like building two dependency graphs.
-     * 
-     * Additionally to the read tasks, two default tasks are added:
-     * - START task, which is prerequisite of all the read tasks that don't have
-     *   any prerequisite.
-     * - END task, which has as prerequisites all the read tasks that are not
-     *   prerequisite of any task.
-     * 
-     * Average cost:
-     * Suppose n is the number of tasks read and m is the number of prerequisite
-     * relations read.
-     * For each task i the cost is:
-     * Reserve or find previous index + Read prerequiste relations = O(1) + O(mi)
-     * Where mi is the number of prerequisite relations of the task i.
-     * 
+     * Maps every task identifier with the index given by read(). It is not updated by
+     * renumber(), see position(). The identifiers are split in parts by their hash (see
+     * part()): read() uses a single part and read_parallel() one part per thread.
+     */
+    vector< unordered_map<string, int> > indexes;
+    
+    /**
+     * Tasks in the order they are visited by calculate_early_times().
+     * It is a topological order of the project when it does not contain a cycle.
+     */
+    vector<int> order;
+    
+    /**
+     * positions[i] is the current index of the task read with index i, after renumber().
+     * It is empty while the tasks keep the indexes given by read().
+     */
+    vector<int> positions;
+    
+    /**
+     * Relations of the tasks in compressed sparse rows, built by renumber(): the childs of
+     * task i are child_edges[child_offsets[i]..child_offsets[i+1]-1], in increasing order,
+     * and the same for the prerequisites. They are empty while the relations are stored in
+     * the vectors of the tasks.
+     */
+    vector<int> child_offsets, child_edges, prerequisite_offsets, prerequisite_edges;
+    
+    /**
+     * Labels of the tasks, built by build_index(): every task is a hub, numbered by the
+     * order in which build_index() processes it. to_hubs[u] has a pair (k, l) when the
+     * longest path from task u to the hub k has length l, and from_hubs[v] has a pair
+     * (k, l) when the longest path from the hub k to task v has length l. The pairs of a
+     * task are sorted by hub, and for every pair of tasks u, v such that v depends on u,
+     * some longest path from u to v goes through a hub in both to_hubs[u] and
+     * from_hubs[v].
+     */
+    vector< vector< pair<int, int> > > to_hubs, from_hubs;
+    
+    /**
+     * Scratch array of calculate_early_times(), kept between calls.
+     */
+    vector<int> counts;
+    
+    /**
+     * Maximum number of scenarios simulated together by simulate_block().
+     * Every array of a block stores the values of all its scenarios contiguously, so the
+     * loops over the scenarios of a task are vectorized.
+     */
+    static const int BLOCK = 64;
+    
+    /**
+     * Maximum size in bytes of the scratch arrays of a thread of simulate(). Large projects
+     * are simulated in narrower blocks, so that they fit.
+     */
+    static const size_t SCRATCH = 64 << 20;
+    
+    /**
+     * Maximum size in bytes of the messages kept by plan_sharded() while it reads the
+     * project, among all the inboxes. They are sent to the shards when it is exceeded.
+     */
+    static const size_t PENDING = 1 << 20;
+    
+    /**
+     * Number of longest path trees sampled by build_index() to choose the order of the
+     * hubs.
+     */
+    static const int SAMPLES = 16;
+    
+    /**
+     * First invalid duration read, empty if all the durations are valid.
+     */
+    string invalid;
+    
+public:
+    /**
+     * Creates an empty project.
+     */
+    Project() : indexes(1)
+    { }
+    
+    /**
+     * Removes all the tasks of the project, so that another project can be read.
+     * The removed tasks are kept, with the memory of their relations, and reused by the
+     * next read(), thus reading a project of a similar size does not allocate memory again.
+     * 
+     * Cost: O(n)
+     */
+    void clear()
+    {
+        while(!tasks.empty())
+        {
+            spare.push_back(move(tasks.back()));
+            tasks.pop_back();
+        }
+        
+        indexes.resize(1);
+        indexes[0].clear();
+        order.clear();
+        positions.clear();
+        child_offsets.clear();
+        child_edges.clear();
+        prerequisite_offsets.clear();
+        prerequisite_edges.clear();
+        to_hubs.clear();
+        from_hubs.clear();
+        invalid.clear();
+    }
+    
+    /**
+     * Reads a project from the input stream.
+     * Each task gets reserved an index in the tasks vector in the order
+     * they are read.
+     * Each task gets related with its prerequisites and the tasks from which
+     * is prerequisite. This is, actually, like building two dependency graphs.
+     * 
+     * Additionally to the read tasks, two default tasks are added:
+     * - START task, which is prerequisite of all the read tasks that don't have
+     *   any prerequisite.
+     * - END task, which has as prerequisites all the read tasks that are not
+     *   prerequisite of any task.
+     * 
+     * Average cost:
+     * Suppose n is the number of tasks read and m is the number of prerequisite
+     * relations read.
+     * For each task i the cost is:
+     * Reserve or find previous index + Read prerequiste relations = O(1) + O(mi)
+     * Where mi is the number of prerequisite relations of the task i.
+     * 
      * If we have n tasks, the cost of reading all of them is:
      * sum{ i=0 -> n }( O(1) + O(mi) ) = O(n) + O(m) = O(n + m)
      * The cost of adding the START and END task is O(n), thus the total cost is:
      * O(n) + O(n + m) = O(n + m)
+     * 
+     * @param in Input stream
+     */
+    void read(istream& in = cin)
+    {
+        read_records([&](string& token)
+        {
+            return (bool) (in >> token);
+        });
+    }
+    
+    /**
+     * Reads a project from the characters [begin, end) of a text loaded in memory, as
+     * read() does from a stream, but without copying the text.
+     * 
+     * Average cost: O(b) + O(n + m), where b = end - begin
+     * 
+     * @param begin First character of the project
+     * @param end Last character of the project + 1
+     */
+    void read(const char* begin, const char* end)
+    {
+        read_records([&](string& token)
+        {
+            while(begin < end and is_space(*begin))
+                ++begin;
+            
+            const char* first = begin;
+            
+            while(begin < end and not is_space(*begin))
+                ++begin;
+            
+            token.assign(first, begin);
+            return begin > first;
+        });
+    }
+    
+    /**
+     * Reads a project from the standard input, as read() does, using several threads.
+     * The input is loaded in memory (see Input) and split in one chunk per thread at task
+     * record boundaries (after a "@" token). Then, every step is done by all the threads:
+     * 1. Every thread parses its chunk into local ids and relations (parse_chunk()).
+     * 2. The ids are split in one part per thread by their hash, and every thread
+     *    inserts the ids of its part of every chunk, in the order of the chunks, in its
+     *    part of indexes. The ids not found are the ones that appear for the first time.
+     * 3. The new ids of every chunk are numbered in order, after the new ids of the
+     *    previous chunks, which is the numbering of read() (order of first appearance).
+     * 4. The durations and relations of every chunk are translated to global indexes and
+     *    grouped (count sort) by the thread that owns the task they are added to: every
+     *    thread owns a range of consecutive tasks.
+     * 5. Every thread adds the durations and relations of its tasks, in the order of
+     *    the chunks, which is the order that read() adds them.
+     * Thus, the project is exactly the same.
+     * 
+     * Average cost:
+     * O(b / t + (n + m) / t), where b is the size of the input and t the number of
+     * threads, plus O(n) to add the START and END tasks.
+     * 
+     * @param threads Number of threads
+     */
+    void read_parallel(int threads)
+    {
+        Input input;
+        const char* text = input.data;
+        size_t size = input.size;
+        
+        // Number of tasks
+        size_t begin = 0;
+        
+        while(begin < size and is_space(text[begin]))
+            ++begin;
+        
+        size_t first = begin;
+        
+        while(begin < size and not is_space(text[begin]))
+            ++begin;
+        
+        int n = atoi(string(text + first, text + begin).c_str());
+        
+        allocate(n+2);
+        
+        // Split the records in chunks of similar size, every chunk ends after a "@" token
+        vector<size_t> bounds(1, begin);
+        
+        for(int t = 1; t < threads; ++t)
+        {
+            size_t i = max(bounds.back(), begin + (size - begin) * t / threads);
+            
+            while(i < size and not (text[i] == '@' and is_space(text[i-1]) and
+                    (i + 1 == size or is_space(text[i+1]))))
+                ++i;
+            
+            bounds.push_back(min(i + 1, size));
+        }
+        
+        bounds.push_back(size);
+        
+        // Runs work(t) for every thread t
+        auto parallel = [&](const function<void(int)>& work)
+        {
+            vector<thread> workers;
+            
+            for(int t = 0; t < threads; ++t)
+                workers.push_back(thread(work, t));
+            
+            for(int t = 0; t < threads; ++t)
+                workers[t].join();
+        };
+        
+        // 1. Parse the chunks
+        vector<Chunk> chunks(threads);
+        
+        parallel([&](int t)
+        {
+            parse_chunk(text, bounds[t], bounds[t+1], threads, chunks[t]);
+        });
+        
+        // Only the first n records are read, ids[t] is the number of ids of their chunk
+        vector<int> ids(threads);
+        int remaining = n;
+        
+        for(int t = 0; t < threads; ++t)
+        {
+            Chunk& chunk = chunks[t];
+            int records = min(remaining, (int) chunk.records.size());
+            
+            ids[t] = records > 0 ? chunk.introduced[records - 1] : 0;
+            chunk.records.resize(records);
+            remaining -= records;
+            
+            if(chunk.invalid_record >= 0 and chunk.invalid_record < records and invalid.empty())
+                invalid = chunk.invalid;
+        }
+        
+        // 2. Insert the ids of every part, entries[t][i] is the entry of the local id i of the
+        // chunk t in indexes, and fresh[t][i] tells whether it appears for the first time
+        typedef pair<const string, int> Entry;
+        
+        vector< vector<Entry*> > entries(threads);
+        vector< vector<char> > fresh(threads);
+        
+        indexes.assign(threads, unordered_map<string, int>());
+        
+        for(int t = 0; t < threads; ++t)
+        {
+            entries[t].resize(ids[t]);
+            fresh[t].resize(ids[t]);
+        }
+        
+        parallel([&](int q)
+        {
+            unordered_map<string, int>& part = indexes[q];
+            part.reserve(n / threads + 1);
+            
+            for(int t = 0; t < threads; ++t)
+            {
+                Chunk& chunk = chunks[t];
+                vector<int>& local = chunk.parts[q];
+                
+                for(int k = 0; k < local.size() and local[k] < ids[t]; ++k)
+                {
+                    int i = local[k];
+                    unordered_map<string, int>::iterator it = part.find(chunk.ids[i]);
+                    
+                    fresh[t][i] = it == part.end();
+                    
+                    if(fresh[t][i])
+                        it = part.insert(make_pair(move(chunk.ids[i]), 0)).first;
+                    
+                    entries[t][i] = &*it;
+                }
+            }
+        });
+        
+        // 3. Number the new ids, the ones of chunk t start at numbers[t]
+        vector<int> numbers(threads + 1, 1);
+        
+        for(int t = 0; t < threads; ++t)
+            numbers[t+1] = numbers[t] + count(fresh[t].begin(), fresh[t].end(), 1);
+        
+        parallel([&](int t)
+        {
+            int number = numbers[t];
+            
+            for(int i = 0; i < ids[t]; ++i)
+            {
+                if(fresh[t][i])
+                {
+                    entries[t][i]->second = number;
+                    tasks[number].id = entries[t][i]->first;
+                    ++number;
+                }
+            }
+        });
+        
+        // 4. Translate and group the durations and relations of every chunk
+        parallel([&](int t)
+        {
+            group_chunk(chunks[t], entries[t], n + 2, threads);
+        });
+        
+        // 5. Add the durations and relations of the tasks of every thread
+        parallel([&](int r)
+        {
+            for(int t = 0; t < threads; ++t)
+            {
+                Chunk& chunk = chunks[t];
+                
+                for(int e = chunk.groups[0][r]; e < chunk.groups[0][r+1]; e += 2)
+                {
+                    Task& task = tasks[chunk.grouped[0][e]];
+                    int record = chunk.grouped[0][e+1];
+                    
+                    task.optimistic = chunk.durations[3*record];
+                    task.duration = chunk.durations[3*record + 1];
+                    task.pessimistic = chunk.durations[3*record + 2];
+                }
+                
+                for(int e = chunk.groups[1][r]; e < chunk.groups[1][r+1]; e += 2)
+                    tasks[chunk.grouped[1][e]].childs.push_back(chunk.grouped[1][e+1]);
+                
+                for(int e = chunk.groups[2][r]; e < chunk.groups[2][r+1]; e += 2)
+                    tasks[chunk.grouped[2][e]].prerequisites.push_back(chunk.grouped[2][e+1]);
+            }
+        });
+        
+        // Add START and END tasks
+        link(n);
+    }
+    
+    /**
+     * Tries to plan the current project.
+     * If a duration of the project is not valid (see parse_duration()) then an error message
+     * is printed.
+     * If the project has a cycle then a warning message is printed.
+     * If the project has not a cycle, then the early and latest times of
+     * every task in the project are calculated and the planning table of
+     * the project is printed.
+     * 
+     * Average cost:
+     * calculate_early_times() has a cost of O(n + m)
+     * calculate_latest_times() has a cost of O(n + m)
+     * print has a cost of O(n)
+     * Where n is the number of the project tasks and m is the number of
+     * prerequisite relations.
+     * 
+     * Thus, the total cost is:
+     * O(n + m) + O(n + m) + O(n) = O(n + m)
+     * If m >> n then the cost is O(m).
+     * 
+     * The tasks are not renumbered (see renumber()): it costs more than the traversal of
+     * calculate_latest_times() it speeds up.
+     * 
+     * @param out Output stream
      */
-    void read()
+    void plan(ostream& out = cout)
+    {
+        if(!invalid.empty())
+        {
+            out << message_duration(invalid) << endl;
+            return;
+        }
+        
+        bool acyclic;
+        
+        {
+            STAT_PHASE(early);
+            acyclic = calculate_early_times();
+        }
+        
+        if(!acyclic)
+            out << message_cycles() << endl;
+        
+        else
+        {
+            // Project has no cycle, thus the next calls are valid
+            {
+                STAT_PHASE(latest);
+                calculate_latest_times();
+            }
+            
+            STAT_PHASE(print);
+            print(out);
+        }
+    }
+    
+    /**
+     * Reads and plans a project whose relations are split among several worker processes
+     * (see Shard), communicating through local sockets. Prints the same output as
+     * read() followed by plan().
+     * 
+     * This process (the coordinator) only keeps the identifiers, durations and times of
+     * the tasks. Every relation read is sent to the owners of its two tasks. Then, both
+     * passes run in rounds: every shard visits the tasks it can visit, as in
+     * calculate_early_times() and calculate_latest_times(), and the times that cross
+     * shards are routed by the coordinator to their owners in the next round. A pass
+     * finishes when a round does not produce messages. If some task has not been visited
+     * by the forward pass, then the project contains a cycle.
+     * 
+     * While the project is read, the messages are sent to the shards whenever all the
+     * inboxes together exceed PENDING bytes, so the memory of the coordinator does not
+     * depend on the number of relations.
+     * 
+     * Average cost:
+     * O(n + m) work, as the unsharded version, plus O(c) messages, where c is the number
+     * of relations between tasks of different shards. The number of rounds is bounded by
+     * the number of times a path of the project changes of shard.
+     * 
+     * @param shards Number of worker processes
+     */
+    void plan_sharded(int shards)
     {
         int n;
         cin >> n;
         
+        int total = n + 2;
+        tasks.resize(total);
+        
+        // Start the worker processes
+        vector<int> sockets(shards);
+        vector<pid_t> workers(shards);
+        
+        for(int k = 0; k < shards; ++k)
+        {
+            int pair[2];
+            
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) < 0)
+                Shard::fail("socketpair");
+            
+            workers[k] = fork();
+            
+            if(workers[k] < 0)
+                Shard::fail("fork");
+            
+            if(workers[k] == 0)
+            {
+                for(int j = 0; j < k; ++j)
+                    close(sockets[j]);
+                
+                close(pair[0]);
+                
+                Shard shard(k, total, shards);
+                shard.run(pair[1]);
+                
+                _exit(0);
+            }
+            
+            close(pair[1]);
+            sockets[k] = pair[0];
+        }
+        
+        vector< vector<int> > inboxes(shards);
+        vector<int> answers;
+        
+        // Number of integers in all the inboxes
+        size_t pending = 0;
+        
+        // Read the tasks as read() does, sending them to the shards in batches
+        for(int i = 1; i <= n; ++i)
+        {
+            string id;
+            cin >> id;
+            
+            int index = get_index(id);
+            Task& task = tasks[index];
+            
+            cin >> id;
+            
+            if(!parse_duration(id.c_str(), task.optimistic, task.duration, task.pessimistic)
+                    and invalid.empty())
+                invalid = id;
+            
+            route(inboxes, total, Shard::TASK, index, tasks[index].duration);
+            pending += 3;
+            
+            cin >> id;
+            while(id != "@")
+            {
+                int requirement_index = get_index(id);
+                
+                route(inboxes, total, Shard::CHILD, index, requirement_index);
+                route(inboxes, total, Shard::PREREQUISITE, requirement_index, index);
+                pending += 6;
+                
+                cin >> id;
+            }
+            
+            if(pending * sizeof(int) > PENDING)
+            {
+                round(sockets, inboxes, total, answers);
+                pending = 0;
+            }
+        }
+        
+        tasks[0].id = "START";
+        tasks.back().id = "END";
+        
+        // Finishes the workers
+        auto finish = [&]()
+        {
+            for(int k = 0; k < shards; ++k)
+            {
+                Shard::send(sockets[k], vector<int>(1, Shard::QUIT));
+                close(sockets[k]);
+                waitpid(workers[k], NULL, 0);
+            }
+        };
+        
+        if(!invalid.empty())
+        {
+            finish();
+            cout << message_duration(invalid) << endl;
+            return;
+        }
+        
+        // Relate START and END with the rest of tasks, and calculate the earliest times
+        for(int k = 0; k < shards; ++k)
+            inboxes[k].insert(inboxes[k].end(), { Shard::LINK, total - 1, 0 });
+        
+        round(sockets, inboxes, total, answers);
+        
+        for(int k = 0; k < shards; ++k)
+            inboxes[k].insert(inboxes[k].end(), { Shard::FORWARD, 0, 0 });
+        
+        while(round(sockets, inboxes, total, answers))
+            ;
+        
+        // Check the visited tasks and get the project length
+        for(int k = 0; k < shards; ++k)
+            inboxes[k].insert(inboxes[k].end(), { Shard::REPORT, 0, 0 });
+        
+        round(sockets, inboxes, total, answers);
+        
+        int visited = 0;
+        int length = 0;
+        
+        for(int i = 0; i < answers.size(); i += 3)
+        {
+            if(answers[i] == Shard::VISITED)
+                visited += answers[i+1];
+            
+            else if(answers[i] == Shard::LENGTH)
+                length = answers[i+1];
+        }
+        
+        bool cycle = visited != total;
+        
+        if(!cycle)
+        {
+            // Calculate the latest times and collect the times of every task
+            for(int k = 0; k < shards; ++k)
+                inboxes[k].insert(inboxes[k].end(), { Shard::BACKWARD, length, 0 });
+            
+            while(round(sockets, inboxes, total, answers))
+                ;
+            
+            for(int k = 0; k < shards; ++k)
+                inboxes[k].insert(inboxes[k].end(), { Shard::COLLECT, 0, 0 });
+            
+            round(sockets, inboxes, total, answers);
+            
+            for(int i = 0; i < answers.size(); i += 3)
+            {
+                if(answers[i] == Shard::START_TIME)
+                    tasks[answers[i+1]].min_start = answers[i+2];
+                else
+                    tasks[answers[i+1]].max_end = answers[i+2];
+            }
+        }
+        
+        finish();
+        
+        if(cycle)
+            cout << message_cycles() << endl;
+        else
+            print();
+    }
+    
+    /**
+     * Simulates the project with random durations (Monte Carlo PERT).
+     * The duration of every task follows a triangular distribution between its optimistic
+     * and pessimistic durations, with the most likely duration as mode, rounded to an
+     * integer. Prints some percentiles of the project length and, for every task, the
+     * percentage of scenarios in which the task is critical. The first column is padded to 6
+     * characters and followed by a space.
+     * If the project has a cycle then a warning message is printed.
+     * 
+     * The topological order of calculate_early_times() is computed once and reused by every
+     * scenario. Scenarios are simulated in blocks by simulate_block(), and blocks are
+     * distributed among the threads. Blocks have BLOCK scenarios, or less when the scratch
+     * arrays of a thread would not fit in SCRATCH bytes, thus the memory of a thread is
+     * O(n) + O(min(BLOCK * n, SCRATCH)). The width of the blocks only depends on n and the
+     * scenarios of a block only depend on the seed and on the block, so the result does not
+     * depend on the number of threads.
+     * If a duration of the project is not valid then an error message is printed.
+     * 
+     * Average cost:
+     * calculate_early_times() + s * O(n + m) + sorting the lengths = O(s * (n + m) + s log s)
+     * Where s is the number of scenarios.
+     * 
+     * @param scenarios Number of scenarios
+     * @param threads Number of threads
+     * @param seed Seed of the random durations
+     * @param topological If true, the tasks are renumbered in topological order with
+     *                    renumber() before simulating, so that the traversals of every
+     *                    block are nearly sequential. The result does not change.
+     */
+    void simulate(int scenarios, int threads, unsigned long seed, bool topological = false)
+    {
+        if(!invalid.empty())
+        {
+            cout << message_duration(invalid) << endl;
+            return;
+        }
+        
+        if(!calculate_early_times())
+        {
+            cout << message_cycles() << endl;
+            return;
+        }
+        
+        if(topological)
+        {
+            STAT_PHASE(renumber);
+            renumber();
+        }
+        
+        int n = tasks.size();
+        
+        // Widest block whose three scratch arrays fit
+        int width = BLOCK;
+        
+        while(width > 1 and 3 * sizeof(int) * n * width > SCRATCH)
+            width /= 2;
+        
+        int blocks = (scenarios + width - 1) / width;
+        threads = max(1, min(threads, blocks));
+        
+        // Project length of every scenario and critical count of every task of every thread
+        vector<int> lengths(blocks * width);
+        vector< vector<long long> > critical(threads, vector<long long>(n));
+        vector<thread> workers;
+        
+        for(int t = 0; t < threads; ++t)
+        {
+            workers.push_back(thread([&, t]()
+            {
+                // Scratch arrays of the thread, reused by all its blocks
+                vector<int> durations(n * width);
+                vector<int> starts(n * width);
+                vector<int> ends(n * width);
+                
+                for(int b = t; b < blocks; b += threads)
+                    simulate_block(seed + b, width, min(width, scenarios - b * width),
+                            durations, starts, ends, &lengths[b * width], critical[t]);
+            }));
+        }
+        
+        for(int t = 0; t < threads; ++t)
+            workers[t].join();
+        
+        lengths.resize(scenarios);
+        sort(lengths.begin(), lengths.end());
+        
+        int percentiles[] = { 5, 25, 50, 75, 95 };
+        
+        cout << left;
+        cout << setw(6) << "N" << ' ' << scenarios << endl;
+        
+        for(int i = 0; i < 5; ++i)
+        {
+            // Nearest rank
+            int rank = max(0, (int) ceil(percentiles[i] / 100.0 * scenarios) - 1);
+            
+            cout << 'P' << setw(5) << percentiles[i] << ' ' << lengths[rank] << endl;
+        }
+        
+        cout << fixed << setprecision(2);
+        
+        for(int i = 0; i < n; ++i)
+        {
+            long long count = 0;
+            
+            for(int t = 0; t < threads; ++t)
+                count += critical[t][position(i)];
+            
+            cout << setw(6) << tasks[position(i)].id << ' ' << 100.0 * count / scenarios << '%'
+                 << endl;
+        }
+    }
+    
+    /**
+     * Plans the project and answers queries about pairs of tasks read from the input
+     * stream, after the project, until the end of the stream. For every pair of ids X Y
+     * prints a line with:
+     * 
+     * X Y LENGTH SLACK
+     * 
+     * Every column but the last one is padded to 6 characters and followed by a space.
+     * Where LENGTH is the duration of the longest chain of tasks from X to Y (the minimum
+     * time between the start of X and the end of Y) and SLACK is the time X can be delayed
+     * without delaying the earliest start of Y. If Y does not depend on X, LENGTH and
+     * SLACK are printed as "-". Unknown ids are reported with an error line.
+     * If a duration of the project is not valid then an error message is printed.
+     * If the project has a cycle then a warning message is printed.
+     * 
+     * Average cost:
+     * O(n + m) to plan the project, the cost of build_index() and, for each query, the
+     * cost of longest_path().
+     */
+    void query()
+    {
+        if(!invalid.empty())
+        {
+            cout << message_duration(invalid) << endl;
+            return;
+        }
+        
+        bool acyclic;
+        
+        {
+            STAT_PHASE(early);
+            acyclic = calculate_early_times();
+        }
+        
+        if(!acyclic)
+        {
+            cout << message_cycles() << endl;
+            return;
+        }
+        
+        {
+            STAT_PHASE(index);
+            build_index();
+        }
+        
+        STAT_PHASE(query);
+        
+        string x, y;
+        
+        cout << left;
+        
+        while(cin >> x >> y)
+        {
+            STAT_ADD(queries, 1);
+            
+            unordered_map<string, int>::iterator from = part(x).find(x);
+            unordered_map<string, int>::iterator to = part(y).find(y);
+            
+            if(from == part(x).end() or to == part(y).end())
+            {
+                cout << "Tarea desconocida: " << (from == part(x).end() ? x : y) << endl;
+                continue;
+            }
+            
+            int u = position(from->second);
+            int v = position(to->second);
+            
+            Task& first = tasks[u];
+            Task& last = tasks[v];
+            
+            int length = longest_path(u, v);
+            
+            // Ids are padded to 6 columns, longer ones are followed by the separator anyway
+            cout << setw(6) << x << ' ' << setw(6) << y << ' ';
+            
+            if(length < 0)
+                cout << setw(6) << '-' << ' ' << '-' << endl;
+            else
+                cout << setw(6) << length + last.duration << ' '
+                     << last.min_start - first.min_start - length << endl;
+        }
+    }
+    
+private:
+    /**
+     * Adds a message to the inbox of the owner of task a.
+     * 
+     * Cost: O(1)
+     * 
+     * @param inboxes Inbox of every shard
+     * @param total Number of tasks
+     * @param operation Operation
+     * @param a Task the message is about
+     * @param b Second field
+     */
+    static void route(vector< vector<int> >& inboxes, int total, int operation, int a, int b)
+    {
+        vector<int>& inbox = inboxes[Shard::owner(a, total, inboxes.size())];
+        
+        inbox.push_back(operation);
+        inbox.push_back(a);
+        inbox.push_back(b);
+    }
+    
+    /**
+     * Sends its inbox to every shard and receives their answers.
+     * First, all the inboxes are sent and then, all the answers are received. A shard
+     * reads its whole batch before answering, so no process waits for another one
+     * that is waiting for it.
+     * Messages for the shards are routed to the inboxes of the next round, and
+     * messages for the coordinator are stored in answers.
+     * 
+     * Cost: O(number of messages)
+     * 
+     * @param sockets Socket of every shard
+     * @param inboxes Inbox of every shard, replaced by the inboxes of the next round
+     * @param total Number of tasks
+     * @param answers Destination of the messages for the coordinator
+     * @return True if some message has been routed to a shard
+     */
+    static bool round(const vector<int>& sockets, vector< vector<int> >& inboxes, int total,
+            vector<int>& answers)
+    {
+        int shards = sockets.size();
+        
+        for(int k = 0; k < shards; ++k)
+        {
+            Shard::send(sockets[k], inboxes[k]);
+            inboxes[k].clear();
+        }
+        
+        answers.clear();
+        
+        bool routed = false;
+        vector<int> batch;
+        
+        STAT_ADD(rounds, 1);
+        
+        for(int k = 0; k < shards; ++k)
+        {
+            Shard::receive(sockets[k], batch);
+            
+            for(int i = 0; i < batch.size(); i += 3)
+            {
+                if(batch[i] >= Shard::VISITED)
+                    answers.insert(answers.end(), batch.begin() + i, batch.begin() + i + 3);
+                else
+                {
+                    route(inboxes, total, batch[i], batch[i+1], batch[i+2]);
+                    routed = true;
+                    STAT_ADD(messages, 1);
+                }
+            }
+        }
+        
+        return routed;
+    }
+    
+    /**
+     * Parses the duration of a task, either certain (d) or uncertain
+     * (optimistic,likely,pessimistic), where optimistic <= likely <= pessimistic.
+     * Any other token, like a partial uncertain duration (4,6) or trailing characters,
+     * is not valid.
+     * 
+     * Cost: O(1)
+     * 
+     * @param token Duration token
+     * @param optimistic Destination of the optimistic duration
+     * @param duration Destination of the most likely duration
+     * @param pessimistic Destination of the pessimistic duration
+     * @return False if the token is not a valid duration
+     */
+    static bool parse_duration(const char* token, int& optimistic, int& duration, int& pessimistic)
+    {
+        // Up to three integers separated by commas
+        long values[3];
+        int count = 0;
+        char* end;
+        
+        while(true)
+        {
+            values[count++] = strtol(token, &end, 10);
+            
+            if(end == token)
+                return false;
+            
+            if(*end != ',' or count == 3)
+                break;
+            
+            token = end + 1;
+        }
+        
+        if(*end != '\0' or count == 2)
+            return false;
+        
+        if(count == 1)
+            values[1] = values[2] = values[0];
+        
+        optimistic = values[0];
+        duration = values[1];
+        pessimistic = values[2];
+        
+        return values[0] <= values[1] and values[1] <= values[2];
+    }
+    
+    /**
+     * Reads the task records of a project and adds the START and END tasks, as described
+     * in read().
+     * 
+     * Average cost: O(n + m)
+     * 
+     * @param next Reads the next token into its argument, returns false at the end of
+     *             the input
+     */
+    template<class Next>
+    void read_records(Next next)
+    {
+        string id;
+        next(id);
+        
+        int n = atoi(id.c_str());
+        
         // We leave some space for the START and END tasks
-        tasks.resize(n+2);
+        allocate(n+2);
         
         for(int i = 1; i <= n; ++i)
         {
-            string id;
-            cin >> id;
+            next(id);
+            
+            // Reserve an index in the tasks vector if id has not been seen before
+            int index = get_index(id);
+            
+            // Read duration, keeping the first invalid one
+            next(id);
+            Task& task = tasks[index];
+            
+            if(!parse_duration(id.c_str(), task.optimistic, task.duration, task.pessimistic)
+                    and invalid.empty())
+                invalid = id;
+            
+            // Read prerequisite relations until the "@" token
+            while(next(id) and id != "@")
+            {
+                int requirement_index = get_index(id);
+                
+                // Establish the prerequisite relations
+                tasks[index].childs.push_back(requirement_index);
+                tasks[requirement_index].prerequisites.push_back(index);
+            }
+        }
+        
+        // Add START and END tasks
+        link(n);
+    }
+    
+    /**
+     * Resizes the tasks vector to count tasks, reusing the tasks removed by clear().
+     * Pre: tasks is empty
+     * 
+     * Cost: O(count)
+     * 
+     * @param count Number of tasks
+     */
+    void allocate(int count)
+    {
+        while(tasks.size() < count and !spare.empty())
+        {
+            tasks.push_back(move(spare.back()));
+            spare.pop_back();
+            
+            tasks.back().clear();
+        }
+        
+        tasks.resize(count);
+    }
+    
+    /**
+     * Adds the START and END tasks to the project, as described in read().
+     * 
+     * Cost: O(n)
+     * 
+     * @param n Number of read tasks
+     */
+    void link(int n)
+    {
+        Task& start = tasks[0];
+        Task& end = tasks.back();
+        
+        start.id = "START";
+        end.id = "END";
+        
+        // Ids of the read tasks are not replaced
+        part(start.id).insert(make_pair(start.id, 0));
+        part(end.id).insert(make_pair(end.id, n+1));
+        
+        for(int i = 1; i <= n; ++i)
+        {
+            // Relate START with tasks that have no prerequisite
+            if(tasks[i].prerequisites.size() == 0)
+            {
+                start.childs.push_back(i);
+                tasks[i].prerequisites.push_back(0);
+            }
+            
+            // Relate END with tasks that aren't prerequisite of any task
+            if(tasks[i].childs.size() == 0)
+            {
+                end.prerequisites.push_back(i);
+                tasks[i].childs.push_back(n+1);
+            }
+        }
+    }
+    
+    /**
+     * Tasks and relations read by a thread of read_parallel(), numbered with local indexes:
+     * the local index of a task id is its position in ids, in order of first appearance.
+     */
+    struct Chunk
+    {
+        /**
+         * Task ids of the chunk, in order of first appearance. parts[q] are the local
+         * indexes of the ids of the part q of indexes, in increasing order.
+         */
+        vector<string> ids;
+        vector< vector<int> > parts;
+        
+        /**
+         * Record r is the task records[r] with durations durations[3*r..3*r+2] and its
+         * relations are edges[2*e..2*e+1] (task, child) for starts[r] <= e < starts[r+1].
+         * introduced[r] is the number of ids that have appeared until the end of record r.
+         */
+        vector<int> records, durations, starts, edges, introduced;
+        
+        /**
+         * First invalid duration of the chunk and its record, -1 if there is none.
+         */
+        string invalid;
+        int invalid_record;
+        
+        /**
+         * Durations and relations translated to global indexes by group_chunk(), grouped
+         * by the thread that owns the task they are added to. The pairs of grouped[s] for
+         * the thread r are in grouped[s][groups[s][r]..groups[s][r+1]-1]:
+         * - grouped[0]: (task, record), the durations of the task are the ones of record.
+         * - grouped[1]: (task, child), in the order of edges.
+         * - grouped[2]: (child, task), in the order of edges.
+         */
+        vector<int> grouped[3], groups[3];
+        
+        Chunk() : invalid_record(-1)
+        { }
+    };
+    
+    /**
+     * Tells whether a character separates tokens.
+     * @param c A character
+     * @return True if c is a white space
+     */
+    static bool is_space(char c)
+    {
+        return c == ' ' or (c >= '\t' and c <= '\r');
+    }
+    
+    /**
+     * Parses the task records of text[begin..end), that must start and end at record
+     * boundaries, into a chunk.
+     * 
+     * Average cost: O(b), where b = end - begin
+     * 
+     * @param text Input text
+     * @param begin First character
+     * @param end Last character + 1
+     * @param parts Number of parts of indexes
+     * @param chunk Destination chunk
+     */
+    static void parse_chunk(const char* text, size_t begin, size_t end, int parts,
+            Chunk& chunk)
+    {
+        unordered_map<string, int> local;
+        chunk.parts.resize(parts);
+        size_t i = begin;
+        
+        // Reads the next token into token, returns false at the end of the chunk
+        string token;
+        auto next = [&]()
+        {
+            while(i < end and is_space(text[i]))
+                ++i;
             
-            // Reserve an index in the tasks vector if id has not been seen before
-            int index = get_index(id);
+            size_t first = i;
             
-            // Read duration
-            cin >> tasks[index].duration;
+            while(i < end and not is_space(text[i]))
+                ++i;
             
-            // Start reading prerequisite relations
-            cin >> id;
-            while(id != "@")
+            token.assign(text + first, i - first);
+            return i > first;
+        };
+        
+        auto index = [&]()
+        {
+            auto it = local.insert(make_pair(token, (int) chunk.ids.size()));
+            
+            if(it.second)
             {
-                int requirement_index = get_index(id);
-                
-                // Establish the prerequisite relations
-                tasks[index].childs.push_back(requirement_index);
-                tasks[requirement_index].prerequisites.push_back(index);
-                
-                cin >> id;
+                chunk.parts[part(token, parts)].push_back(chunk.ids.size());
+                chunk.ids.push_back(token);
             }
-        }
-        
-        // Add START and END tasks
-        Task& start = tasks[0];
-        Task& end = tasks.back();
+            
+            return it.first->second;
+        };
         
-        start.id = "START";
-        end.id = "END";
+        chunk.starts.push_back(0);
         
-        for(int i = 1; i <= n; ++i)
+        while(next())
         {
-            // Relate START with tasks that have no prerequisite
-            if(tasks[i].prerequisites.size() == 0)
+            int task = index();
+            chunk.records.push_back(task);
+            
+            int optimistic = 0, duration = 0, pessimistic = 0;
+            
+            if(!(next() and parse_duration(token.c_str(), optimistic, duration, pessimistic))
+                    and chunk.invalid_record < 0)
             {
-                start.childs.push_back(i);
-                tasks[i].prerequisites.push_back(0);
+                chunk.invalid = token;
+                chunk.invalid_record = chunk.records.size() - 1;
             }
             
-            // Relate END with tasks that aren't prerequisite of any task
-            if(tasks[i].childs.size() == 0)
+            chunk.durations.push_back(optimistic);
+            chunk.durations.push_back(duration);
+            chunk.durations.push_back(pessimistic);
+            
+            while(next() and token != "@")
             {
-                end.prerequisites.push_back(i);
-                tasks[i].childs.push_back(n+1);
+                chunk.edges.push_back(task);
+                chunk.edges.push_back(index());
             }
+            
+            chunk.starts.push_back(chunk.edges.size() / 2);
+            chunk.introduced.push_back(chunk.ids.size());
         }
     }
     
     /**
-     * Tries to plan the current project.
-     * If the project has a cycle then a warning message is printed.
-     * If the project has not a cycle, then the early and latest times of
-     * every task in the project are calculated and the planning table of
-     * the project is printed.
+     * Translates the first records of a chunk to global indexes and groups them by the
+     * thread that owns their task, using a stable counting sort (see Chunk::grouped).
      * 
-     * Average cost:
-     * calculate_early_times() has a cost of O(n + m)
-     * calculate_latest_times() has a cost of O(n + m)
-     * print has a cost of O(n)
-     * Where n is the number of the project tasks and m is the number of
-     * prerequisite relations.
+     * Cost: O(r + e + t), where r and e are the records and relations of the chunk
      * 
-     * Thus, the total cost is:
-     * O(n + m) + O(n + m) + O(n) = O(n + m)
-     * If m >> n then the cost is O(m).
+     * @param chunk A chunk, only its records are translated
+     * @param entries entries[i] is the entry of indexes of the local index i
+     * @param count Number of tasks
+     * @param threads Number of threads, every one owns a range of tasks (Shard::owner())
      */
-    void plan()
+    static void group_chunk(Chunk& chunk, const vector< pair<const string, int>* >& entries,
+            int count, int threads)
     {
-        if(!calculate_early_times())
-            cout << message_cycles() << endl;
+        int records = chunk.records.size();
+        int edges = chunk.starts[records];
+        int sizes[3] = { records, edges, edges };
         
-        else
+        // Global indexes of the records and relations, 2 per pair
+        vector<int> pairs[3];
+        
+        for(int s = 0; s < 3; ++s)
+            pairs[s].resize(2 * sizes[s]);
+        
+        for(int r = 0; r < records; ++r)
         {
-            // Project has no cycle, thus the next call is valid
-            calculate_latest_times();
-            print();
+            pairs[0][2*r] = entries[chunk.records[r]]->second;
+            pairs[0][2*r + 1] = r;
+        }
+        
+        for(int e = 0; e < edges; ++e)
+        {
+            int task = entries[chunk.edges[2*e]]->second;
+            int child = entries[chunk.edges[2*e + 1]]->second;
+            
+            pairs[1][2*e] = task;
+            pairs[1][2*e + 1] = child;
+            pairs[2][2*e] = child;
+            pairs[2][2*e + 1] = task;
+        }
+        
+        for(int s = 0; s < 3; ++s)
+        {
+            vector<int>& groups = chunk.groups[s];
+            groups.assign(threads + 1, 0);
+            
+            for(int k = 0; k < sizes[s]; ++k)
+                groups[Shard::owner(pairs[s][2*k], count, threads) + 1] += 2;
+            
+            for(int r = 0; r < threads; ++r)
+                groups[r+1] += groups[r];
+            
+            vector<int> cursor(groups.begin(), groups.end() - 1);
+            chunk.grouped[s].resize(2 * sizes[s]);
+            
+            for(int k = 0; k < sizes[s]; ++k)
+            {
+                int& c = cursor[Shard::owner(pairs[s][2*k], count, threads)];
+                
+                chunk.grouped[s][c] = pairs[s][2*k];
+                chunk.grouped[s][c+1] = pairs[s][2*k + 1];
+                c += 2;
+            }
         }
+        
+        // The chunk is not needed anymore
+        vector<string>().swap(chunk.ids);
+        vector<int>().swap(chunk.edges);
     }
     
-private:
     /**
      * Gets the reserved index in the tasks vector for the given task id.
      * If the id has been seen before it returns the previously reserved index.
      * If the id has not been seen before it reserves and returns a new index.
+     * Pre: indexes has a single part
      * 
      * Average cost:
      * Find index + Add index = O(1) + O(1) = O(1)
@@ -191,13 +1920,13 @@ private:
      * @param id A task id
      * @return The reserved index
      */
-    int get_index(string id)
+    int get_index(const string& id)
     {
         // Try to find the id in the indexes map
-        unordered_map<string, int>::iterator it = indexes.find(id);
+        unordered_map<string, int>::iterator it = indexes[0].find(id);
         
         // If not found, reserve and return a new index
-        if(it == indexes.end())
+        if(it == indexes[0].end())
             return add(id);
         
         // If found, return the previously reserved index
@@ -206,17 +1935,18 @@ private:
     
     /**
      * Reserves a new index for the given task id.
+     * Pre: indexes has a single part
      * 
      * Average cost: O(1)
      * 
      * @param id A task id
      * @return The reserved index
      */
-    int add(string id)
+    int add(const string& id)
     {
         // Reserve new index
-        int index = indexes.size() + 1;
-        indexes[id] = index;
+        int index = indexes[0].size() + 1;
+        indexes[0][id] = index;
         
         // Set task id
         tasks[index].id = id;
@@ -224,6 +1954,33 @@ private:
         return index;
     }
     
+    /**
+     * Gets the part of indexes that contains the given task id.
+     * 
+     * Average cost: O(1)
+     * 
+     * @param id A task id
+     * @return The part where id is, or would be, stored
+     */
+    unordered_map<string, int>& part(const string& id)
+    {
+        return indexes[part(id, indexes.size())];
+    }
+    
+    /**
+     * Gets the part of the given task id when the identifiers are split in parts.
+     * 
+     * Average cost: O(1)
+     * 
+     * @param id A task id
+     * @param parts Number of parts
+     * @return Part of id, in [0, parts)
+     */
+    static int part(const string& id, int parts)
+    {
+        return hash<string>()(id) % parts;
+    }
+    
     /**
      * Calculates the early times of every task in the project.
      * 
@@ -257,166 +2014,708 @@ private:
         
         // prerequisite_count[i] contains the number of prerequisites tasks
         // of the task i which have not been visited yet
-        vector<int> prerequisite_count(unvisited);
+        vector<int>& prerequisite_count = counts;
+        prerequisite_count.resize(unvisited);
+        
+        // Initially all tasks are unvisited, thus the prerequisite count
+        // of a task i is the total number of prerequisites of the task i
+        for(int i = 0; i < unvisited; ++i)
+            prerequisite_count[i] = prerequisites(i).size();
+        
+        // The tasks are added to order when they become pending, and visited in the same
+        // order: order[0..head-1] are the visited tasks and order[head..] the pending ones,
+        // the tasks i where prerequisite_count[i] == 0
+        int head = 0;
+        order.clear();
+        
+        // Initially the START task is the only one with prerequisite_count == 0.
+        // This is because when reading the project the START task is set as prerequisite
+        // of all the tasks that have no prerequisites.
+        order.push_back(0); // Add START task
+        
+        // Invariants:
+        // - unvisited = number of tasks not visited yet
+        // - prerequisite_count[i] = number of prerequisites tasks of task i not visited yet
+        // - order[head..] = tasks where prerequisite_count[i] == 0, not visited yet
+        // - unvisited tasks have set the early start time as the maximum of the early end times
+        //   of its prerequisite visited tasks. This implies that visited tasks have the earliest
+        //   start time set correctly.
+        while(head < order.size())
+        {
+            // Get and pop first unvisited task
+            Task& current = tasks[order[head]];
+            Relations current_childs = childs(order[head++]);
+            
+            // The earliest start time of a task i is the maximum of the earliest
+            // end times of its prerequisites
+            // Calculate the earliest end time of the current task
+            int min_end = current.min_start + current.duration;
+            
+            // For each task i that is a child of the current task:
+            for(int i = 0; i < current_childs.size(); ++i)
+            {
+                int child = current_childs[i];
+                
+                // If the earliest end time of the current task is greater than the
+                // earliest start time of the task i. We update the start time to
+                // fulfill the invariant.
+                if(min_end > tasks[child].min_start)
+                    tasks[child].min_start = min_end;
+                
+                // Current task is a visited task now, thus is necessary to update the
+                // prerequisite count of the task i, and if it results to be 0 we add the
+                // task i to the pending queue to fulfill the invariant.
+                if(--prerequisite_count[child] == 0)
+                    order.push_back(child);
+            }
+            
+            STAT_ADD(relaxed, current_childs.size());
+            STAT_MAX(early_queue_max, order.size() - head + 1);
+            
+            // Current task is a visited task now
+            --unvisited;
+        }
+        
+        STAT_ADD(visited, tasks.size() - unvisited);
+        
+        // Now, by invariant, all the visited tasks have the earliest start time set correctly.
+        // But the project can contain a cycle.
+        // If, and only if, the project contains a cycle then unvisited is not equal to 0.
+        
+        // This can be proven easily:
+        // Project contains a cycle => unvisited != 0
+        // A task is only marked as visited when all its prerequisites are visited.
+        // If the project has a cycle, it means that exists a prerequisite relation:
+        // A -> T1 -> T2 -> ... Tn-1 -> Tn -> A, where n >= 0
+        // Thus, A is only going to be marked as visited when Tn is visited, and Tn only
+        // when Tn-1, and so on. Lastly we found that T1 can only be visited if A is visited.
+        // Thus we found that A can only be visited if A has been visited, and that
+        // is impossible.
+        
+        // unvisited != 0 => Project contains a cycle
+        // Suppose that unvisited != 0 and project does not contain a cycle.
+        // This means (by invariant) that exists some task t that remains unvisited, but this
+        // can only happen if the task has a prerequisite that has not been visited, and so on.
+        // But this can not go forever, because there is a finite number of tasks and the
+        // prerequisite graph is connected (because START and END tasks).
+        // Thus, there is a cycle of unvisited tasks.
+        
+        // If unvisited equals 0 then the project does not have a cycle, this means that all
+        // tasks have the earliest start time set correctly, then we return true.
+        // If unvisited is not equal to 0 then the project contains a cycle and we return false,
+        // as described above.
+        return unvisited == 0;
+    }
+    
+    /**
+     * Renumbers the tasks following the topological order of calculate_early_times(), so
+     * that the prerequisites of a task always have smaller indexes than the task, and moves
+     * their relations to compressed arrays in the new order (child_offsets, child_edges,
+     * prerequisite_offsets and prerequisite_edges). Then the traversals of the project visit
+     * the tasks and their relations nearly sequentially in memory, instead of jumping
+     * between tasks numbered in order of appearance. START keeps the index 0 and END the
+     * last one. The vectors of the tasks are emptied, but they keep their memory, like
+     * clear() does.
+     * Pre: calculate_early_times() has been called, the project does not contain a cycle
+     *      and it has not been renumbered yet
+     * 
+     * The relations are listed in increasing order without sorting them: the tasks are
+     * visited in the new order and every task is appended to the childs of its
+     * prerequisites, and to the prerequisites of its childs.
+     * 
+     * Average cost: O(n + m)
+     */
+    void renumber()
+    {
+        int n = tasks.size();
+        
+        // New index of every task
+        vector<int> target(n);
+        
+        for(int k = 0; k < n; ++k)
+            target[order[k]] = k;
+        
+        // Move the tasks to their new index, their relations keep the old indexes
+        vector<Task> renumbered(n);
+        
+        for(int k = 0; k < n; ++k)
+        {
+            renumbered[k] = move(tasks[order[k]]);
+            order[k] = k;
+        }
+        
+        tasks.swap(renumbered);
+        
+        // Side 0 are the childs and side 1 the prerequisites: task k is a child of its
+        // prerequisites and a prerequisite of its childs
+        vector<int> offsets[2];
+        vector<int> edges[2];
+        vector<int> cursor;
+        
+        for(int side = 0; side < 2; ++side)
+        {
+            offsets[side].resize(n + 1);
+            offsets[side][0] = 0;
+            
+            for(int k = 0; k < n; ++k)
+                offsets[side][k+1] = offsets[side][k] +
+                    (side == 0 ? tasks[k].childs : tasks[k].prerequisites).size();
+            
+            edges[side].resize(offsets[side][n]);
+            cursor.assign(offsets[side].begin(), offsets[side].end() - 1);
+            
+            for(int k = 0; k < n; ++k)
+            {
+                vector<int>& related = side == 0 ? tasks[k].prerequisites : tasks[k].childs;
+                
+                for(int i = 0; i < related.size(); ++i)
+                    edges[side][cursor[target[related[i]]]++] = k;
+            }
+        }
+        
+        // The vectors of the tasks keep their memory
+        for(int k = 0; k < n; ++k)
+        {
+            tasks[k].childs.clear();
+            tasks[k].prerequisites.clear();
+        }
+        
+        child_offsets.swap(offsets[0]);
+        child_edges.swap(edges[0]);
+        prerequisite_offsets.swap(offsets[1]);
+        prerequisite_edges.swap(edges[1]);
+        
+        if(positions.empty())
+            positions.swap(target);
+        else
+            for(int i = 0; i < n; ++i)
+                positions[i] = target[positions[i]];
+    }
+    
+    /**
+     * Builds the index used by longest_path() to answer queries between pairs of tasks:
+     * pruned 2-hop labels (see to_hubs and from_hubs).
+     * Pre: calculate_early_times() has been called and the project does not contain a cycle
+     * 
+     * The transitive closure of a large project is usually dense (most tasks depend on
+     * most of the earlier ones), so storing the longest path between every pair of tasks
+     * does not fit in memory. Instead, the tasks are renumbered in topological order and
+     * they are processed as hubs one by one, by importance. The labels of a hub are found
+     * by two searches, one to its descendants and one to its ancestors (see
+     * label_hub()), that stop at the tasks whose longest path with the hub is already
+     * given by the labels of the previous hubs. A pair u, v is labeled by the first hub
+     * of a longest path from u to v, because that path is not found by the previous hubs,
+     * thus the labels answer every query.
+     * 
+     * The size of the labels depends on the order of the hubs. The first hubs should be
+     * in many longest paths, so that the searches of the rest stop soon:
+     * - The importance of a task is the number of tasks below it in SAMPLES longest path
+     *   trees (descendants and ancestors) of random tasks.
+     * - It is multiplied by 1.5 for every factor 2 of the level of the task (its number
+     *   of tasks in a longest chain from START). Every path from a level to a later one
+     *   goes through the levels between, or skips them with a long relation, so
+     *   the tasks of the levels that split the project in halves, quarters, etc. are
+     *   processed before the rest.
+     * 
+     * Average cost:
+     * O(SAMPLES * (n + m) + n log n) to choose the order, plus O(h * (d log n + l)) for
+     * the searches, where h is the total number of labels, d the average number of
+     * relations of a task and l the average number of labels of a task. Both h / n and l
+     * grow slowly with n: 50 to 70 labels per task on projects of 10^6 tasks.
+     */
+    void build_index()
+    {
+        int n = tasks.size();
+        
+        renumber();
+        
+        // Levels of the tasks, in topological order
+        vector<int> levels(n, 0);
+        
+        for(int i = 0; i < n; ++i)
+        {
+            Relations next = childs(i);
+            
+            for(int k = 0; k < next.size(); ++k)
+                levels[next[k]] = max(levels[next[k]], levels[i] + 1);
+        }
+        
+        // Importance of the tasks
+        vector<double> scores(n, 1);
+        mt19937 random;
+        
+        for(int s = 0; s < SAMPLES; ++s)
+        {
+            int root = random() % n;
+            
+            sample_paths(root, true, scores);
+            sample_paths(root, false, scores);
+        }
+        
+        for(int i = 0; i < n; ++i)
+            for(int level = levels[i] + 1; level % 2 == 0; level /= 2)
+                scores[i] *= 1.5;
+        
+        vector<int> hubs(n);
+        
+        for(int i = 0; i < n; ++i)
+            hubs[i] = i;
+        
+        stable_sort(hubs.begin(), hubs.end(), [&](int u, int v)
+        {
+            return scores[u] > scores[v];
+        });
+        
+        // Labels of every hub, in order
+        vector<int> lengths(n, -1), hub_lengths(n, -1);
+        
+        to_hubs.resize(n);
+        from_hubs.resize(n);
+        
+        for(int k = 0; k < n; ++k)
+        {
+            label_hub(hubs[k], k, true, lengths, hub_lengths);
+            label_hub(hubs[k], k, false, lengths, hub_lengths);
+        }
+        
+        long long labels = 0;
+        
+        for(int i = 0; i < n; ++i)
+        {
+            to_hubs[i].shrink_to_fit();
+            from_hubs[i].shrink_to_fit();
+            
+            labels += to_hubs[i].size() + from_hubs[i].size();
+        }
+        
+        STAT_ADD(index_bytes, (long long) positions.size() * sizeof(int)
+                + labels * sizeof(pair<int, int>) + 2LL * n * sizeof(vector< pair<int, int> >));
+    }
+    
+    /**
+     * Adds to scores the number of tasks below every task in a longest path tree of the
+     * descendants (or the ancestors) of a task: the longest path from the root to every
+     * task goes through the tasks above it.
+     * Pre: the tasks are in topological order (renumber())
+     * 
+     * Cost: O(n + m)
+     * 
+     * @param root Root of the tree
+     * @param descendants True to follow the childs of the tasks, false the prerequisites
+     * @param scores Score of every task
+     */
+    void sample_paths(int root, bool descendants, vector<double>& scores)
+    {
+        int n = tasks.size();
+        int step = descendants ? 1 : -1;
+        int end = descendants ? n : -1;
+        
+        vector<int> lengths(n, -1), parents(n, -1), below(n, 0);
+        lengths[root] = 0;
+        
+        for(int i = root; i != end; i += step)
+        {
+            if(lengths[i] < 0)
+                continue;
+            
+            Relations next = descendants ? childs(i) : prerequisites(i);
+            
+            for(int k = 0; k < next.size(); ++k)
+            {
+                int task = next[k];
+                int length = lengths[i] + tasks[descendants ? i : task].duration;
+                
+                if(length > lengths[task])
+                {
+                    lengths[task] = length;
+                    parents[task] = i;
+                }
+            }
+        }
+        
+        // Every task is below its parent, visited after it
+        for(int i = end - step; i != root - step; i -= step)
+        {
+            if(lengths[i] < 0)
+                continue;
+            
+            below[i] += 1;
+            scores[i] += below[i];
+            
+            if(parents[i] >= 0)
+                below[parents[i]] += below[i];
+        }
+    }
+    
+    /**
+     * Labels the descendants (or the ancestors) of a hub with their longest path from (or
+     * to) the hub, in topological order (or reverse topological order). The search stops
+     * at the tasks whose longest path is already given by the labels of the previous hubs.
+     * Pre: the tasks are in topological order, the previous hubs are labeled and lengths
+     * and hub_lengths are filled with -1
+     * 
+     * Average cost: O(v * (d log v + l)), where v is the number of labeled tasks
+     * 
+     * @param hub A task
+     * @param rank Number of the hub
+     * @param descendants True to label the descendants, false the ancestors
+     * @param lengths Scratch array of n elements
+     * @param hub_lengths Scratch array of n elements
+     */
+    void label_hub(int hub, int rank, bool descendants, vector<int>& lengths,
+            vector<int>& hub_lengths)
+    {
+        vector< vector< pair<int, int> > >& labels = descendants ? from_hubs : to_hubs;
+        vector< pair<int, int> >& hub_labels = descendants ? to_hubs[hub] : from_hubs[hub];
         
-        // Initially all tasks are unvisited, thus the prerequisite count
-        // of a task i is the total number of prerequisites of the task i
-        for(int i = 0; i < unvisited; ++i)
-            prerequisite_count[i] = tasks[i].prerequisites.size();
+        // hub_lengths[k] is the longest path between the hub and the hub k
+        for(int i = 0; i < hub_labels.size(); ++i)
+            hub_lengths[hub_labels[i].first] = hub_labels[i].second;
         
-        // pending contains the tasks i where prerequisite_count[i] == 0
-        queue<int> pending;
+        // The queue gives the tasks in topological order, or in reverse topological order
+        priority_queue<int> pending;
+        vector<int> found(1, hub);
+        int sign = descendants ? -1 : 1;
         
-        // Initially the START task is the only one with prerequisite_count == 0.
-        // This is because when reading the project the START task is set as prerequisite
-        // of all the tasks that have no prerequisites.
-        pending.push(0); // Add START task
+        lengths[hub] = 0;
+        pending.push(sign * hub);
         
-        // Invariants:
-        // - unvisited = number of tasks not visited yet
-        // - prerequisite_count[i] = number of prerequisites tasks of task i not visited yet
-        // - pending = tasks where prerequisite_count[i] == 0
-        // - unvisited tasks have set the early start time as the maximum of the early end times
-        //   of its prerequisite visited tasks. This implies that visited tasks have the earliest
-        //   start time set correctly.
         while(!pending.empty())
         {
-            // Get and pop first unvisited task
-            Task& current = tasks[pending.front()];
+            int current = sign * pending.top();
+            int length = lengths[current];
+            
             pending.pop();
             
-            // The earliest start time of a task i is the maximum of the earliest
-            // end times of its prerequisites
-            // Calculate the earliest end time of the current task
-            int min_end = current.min_start + current.duration;
+            if(current != hub and covered(labels[current], hub_lengths, length))
+                continue;
             
-            // For each task i that is a child of the current task:
-            for(int i = 0; i < current.childs.size(); ++i)
+            labels[current].push_back(make_pair(rank, length));
+            
+            Relations next = descendants ? childs(current) : prerequisites(current);
+            
+            for(int k = 0; k < next.size(); ++k)
             {
-                int child = current.childs[i];
+                int task = next[k];
                 
-                // If the earliest end time of the current task is greater than the
-                // earliest start time of the task i. We update the start time to
-                // fulfill the invariant.
-                if(min_end > tasks[child].min_start)
-                    tasks[child].min_start = min_end;
+                if(lengths[task] < 0)
+                {
+                    found.push_back(task);
+                    pending.push(sign * task);
+                }
                 
-                // Current task is a visited task now, thus is necessary to update the
-                // prerequisite count of the task i, and if it results to be 0 we add the
-                // task i to the pending queue to fulfill the invariant.
-                if(--prerequisite_count[child] == 0)
-                    pending.push(child);
+                lengths[task] = max(lengths[task],
+                        length + tasks[descendants ? current : task].duration);
             }
+        }
+        
+        for(int i = 0; i < found.size(); ++i)
+            lengths[found[i]] = -1;
+        
+        for(int i = 0; i < hub_labels.size(); ++i)
+            hub_lengths[hub_labels[i].first] = -1;
+    }
+    
+    /**
+     * Checks whether the labels of a task already give a path of a length with a hub.
+     * 
+     * Cost: O(l), where l is the number of labels of the task
+     * 
+     * @param labels Labels of the task
+     * @param hub_lengths Longest path between the hub and every hub, -1 if there is none
+     * @param length Length of a path between the task and the hub
+     * @return True if the labels give a path of at least that length
+     */
+    static bool covered(const vector< pair<int, int> >& labels, const vector<int>& hub_lengths,
+            int length)
+    {
+        for(int i = 0; i < labels.size(); ++i)
+        {
+            int hub_length = hub_lengths[labels[i].first];
             
-            // Current task is a visited task now
-            --unvisited;
+            if(hub_length >= 0 and hub_length + labels[i].second >= length)
+                return true;
         }
         
-        // Now, by invariant, all the visited tasks have the earliest start time set correctly.
-        // But the project can contain a cycle.
-        // If, and only if, the project contains a cycle then unvisited is not equal to 0.
+        return false;
+    }
+    
+    /**
+     * Calculates the longest path from the start of task x to the start of task y: the
+     * maximum sum of the durations of the tasks of a chain from x to y, excluding y.
+     * It is the longest path through the common hubs of to_hubs[x] and from_hubs[y],
+     * found merging both sorted lists.
+     * Pre: build_index() has been called
+     * 
+     * Cost: O(l), where l is the number of labels of x and y
+     * 
+     * @param x Index of the first task
+     * @param y Index of the last task
+     * @return Length of the longest path, or -1 if y does not depend on x
+     */
+    int longest_path(int x, int y)
+    {
+        const vector< pair<int, int> >& first = to_hubs[x];
+        const vector< pair<int, int> >& last = from_hubs[y];
         
-        // This can be proven easily:
-        // Project contains a cycle => unvisited != 0
-        // A task is only marked as visited when all its prerequisites are visited.
-        // If the project has a cycle, it means that exists a prerequisite relation:
-        // A -> T1 -> T2 -> ... Tn-1 -> Tn -> A, where n >= 0
-        // Thus, A is only going to be marked as visited when Tn is visited, and Tn only
-        // when Tn-1, and so on. Lastly we found that T1 can only be visited if A is visited.
-        // Thus we found that A can only be visited if A has been visited, and that
-        // is impossible.
+        int best = -1;
+        int i = 0, j = 0;
         
-        // unvisited != 0 => Project contains a cycle
-        // Suppose that unvisited != 0 and project does not contain a cycle.
-        // This means (by invariant) that exists some task t that remains unvisited, but this
-        // can only happen if the task has a prerequisite that has not been visited, and so on.
-        // But this can not go forever, because there is a finite number of tasks and the
-        // prerequisite graph is connected (because START and END tasks).
-        // Thus, there is a cycle of unvisited tasks.
+        while(i < first.size() and j < last.size())
+        {
+            if(first[i].first < last[j].first)
+                ++i;
+            
+            else if(first[i].first > last[j].first)
+                ++j;
+            
+            else
+            {
+                best = max(best, first[i].second + last[j].second);
+                ++i;
+                ++j;
+            }
+        }
         
-        // If unvisited equals 0 then the project does not have a cycle, this means that all
-        // tasks have the earliest start time set correctly, then we return true.
-        // If unvisited is not equal to 0 then the project contains a cycle and we return false,
-        // as described above.
-        return unvisited == 0;
+        STAT_ADD(query_labels, i + j);
+        
+        return best;
+    }
+    
+    /**
+     * Returns the current index of the task read with index i.
+     * 
+     * Cost: O(1)
+     * 
+     * @param i Index given to the task by read()
+     * @return Index of the task in the tasks vector
+     */
+    int position(int i) const
+    {
+        return positions.empty() ? i : positions[i];
+    }
+    
+    /**
+     * Returns the tasks from which task i is prerequisite.
+     * 
+     * Cost: O(1)
+     * 
+     * @param i Index of a task
+     * @return Childs of the task
+     */
+    Relations childs(int i) const
+    {
+        if(child_offsets.empty())
+            return Relations(tasks[i].childs.data(),
+                    tasks[i].childs.data() + tasks[i].childs.size());
+        
+        return Relations(child_edges.data() + child_offsets[i],
+                child_edges.data() + child_offsets[i+1]);
+    }
+    
+    /**
+     * Returns the tasks that are prerequisite of task i.
+     * 
+     * Cost: O(1)
+     * 
+     * @param i Index of a task
+     * @return Prerequisites of the task
+     */
+    Relations prerequisites(int i) const
+    {
+        if(prerequisite_offsets.empty())
+            return Relations(tasks[i].prerequisites.data(),
+                    tasks[i].prerequisites.data() + tasks[i].prerequisites.size());
+        
+        return Relations(prerequisite_edges.data() + prerequisite_offsets[i],
+                prerequisite_edges.data() + prerequisite_offsets[i+1]);
     }
     
     /**
      * Calculates the latest times of every task in the project.
-     * Pre: The project does not contain a cycle
+     * Pre: calculate_early_times() has been called and the project does not contain a cycle
+     * 
+     * The tasks are visited in the reverse of the topological order stored by
+     * calculate_early_times(). After renumber(), it is a sequential scan from the END task.
      * 
      * Average cost:
-     * The cost is equal to the calculate_earliest_times() method because they have the same
-     * algorithmic structure.
+     * Every task i is visited once and for every prerequisite of the task some constant
+     * cost operations are performed.
      * O(n + m)
      */
     void calculate_latest_times()
     {
-        // Proof of correctness:
-        // child_count[i] contains the number of childs of the task i that have not been
-        // visited yet
-        vector<int> child_count(tasks.size());
-        
         // END task latest end time is equal to the earlist end time
         Task& end = tasks.back();
         end.max_end = end.min_start + end.duration;
         
+        // The latest end time of a task i is the minimum of the latest
+        // start times of its childs.
+        // Thus, initially the latest end time of all the tasks is set to the
+        // end time of the project as the limit.
         for(int i = 0; i < tasks.size(); ++i)
-        {
-            // Initially all tasks are unvisited, thus the child count
-            // of a task i is the total number of childs of the task i
-            child_count[i] = tasks[i].childs.size();
-            
-            // The latest end time of a task i is the minimum of the latest
-            // start times of its childs.
-            // Thus, initially the latest end time of all the tasks is set to the
-            // end time of the project as the limit.
             tasks[i].max_end = end.max_end; // Set maximum project time
-        }
-        
-        // pending contains the tasks i where prerequisite_count[i] == 0
-        queue<int> pending;
         
-        // Initially the END task is the only one with child_count == 0.
-        // This is because when reading the project the END task is set as child
-        // of all the tasks that have no childs.
-        pending.push(tasks.size() - 1); // Add END task
-        
-        // Invariants:
-        // - child_count[i] = number of child tasks of task i not visited yet
-        // - pending = tasks where child_count[i] == 0
-        // - unvisited tasks have set the lastest end time as the minimum of the latest
-        //   start times of its child visited tasks. This implies that visited tasks have
-        //   the latest end time set correctly.
-        while(!pending.empty())
+        // Proof of correctness:
+        // Every child of a task follows the task in the topological order, thus all the
+        // childs of a task are visited before the task.
+        // Invariant: unvisited tasks have set the lastest end time as the minimum of the
+        // latest start times of its child visited tasks. This implies that visited tasks
+        // have the latest end time set correctly.
+        for(int k = order.size() - 1; k >= 0; --k)
         {
-            Task& current = tasks[pending.front()];
-            pending.pop();
+            Task& current = tasks[order[k]];
+            Relations current_prerequisites = prerequisites(order[k]);
             
             // Calculate the latest start time of the current task
             int max_start = current.max_end - current.duration;
             
             // For each prerequisite of the current task i:
-            for(int i = 0; i < current.prerequisites.size(); ++i)
+            for(int i = 0; i < current_prerequisites.size(); ++i)
             {
-                int prerrequisite = current.prerequisites[i];
+                int prerrequisite = current_prerequisites[i];
                 
                 // If the current task (child) has a latest start time less than the
                 // latest end time of i, then is necessary to update the end time to
                 // fulfill the invariant.
                 if(max_start < tasks[prerrequisite].max_end)
                     tasks[prerrequisite].max_end = max_start;
-                
-                // Current task is a visited task now, thus is necessary to update the
-                // child count of the task i, and if it results to be 0 we add the task i to
-                // the pending queue to fulfill the invariant.
-                if(--child_count[prerrequisite] == 0)
-                    pending.push(prerrequisite);
             }
+            
+            STAT_ADD(relaxed, current_prerequisites.size());
         }
         
         // Now, by invariant, and because the project does not contain any cicles (precondition),
-        // all the visited tasks have the latest end time set correctly.
+        // all the tasks have the latest end time set correctly.
+    }
+    
+    /**
+     * Simulates a block of width scenarios of the project, at most BLOCK.
+     * Pre: calculate_early_times() has been called and the project does not contain a cycle
+     * 
+     * Every array stores, for every task i, the values of the scenarios of the block in
+     * positions [i*width, (i+1)*width) (struct of arrays). The early and latest times are
+     * calculated as in calculate_early_times() and calculate_latest_times(), but following
+     * the stored topological order, so that the loops over the scenarios have no
+     * dependencies between them and are vectorized.
+     * 
+     * Average cost: O(width * (n + m))
+     * 
+     * @param seed Seed of the random durations of the block
+     * @param width Number of scenarios of the block
+     * @param valid Number of scenarios of the block that are counted
+     * @param durations Scratch array of durations
+     * @param starts Scratch array of earliest start times
+     * @param ends Scratch array of latest end times
+     * @param lengths Destination of the project length of every scenario
+     * @param critical critical[i] is increased by the number of scenarios where i is critical
+     */
+    void simulate_block(unsigned long seed, int width, int valid, vector<int>& durations,
+            vector<int>& starts, vector<int>& ends, int* lengths, vector<long long>& critical)
+    {
+        int n = tasks.size();
+        
+        mt19937_64 random(seed);
+        
+        // Random durations, triangular distribution by inversion.
+        // They are drawn in the order of read(), so they do not depend on renumber().
+        for(int i = 0; i < n; ++i)
+        {
+            Task& task = tasks[position(i)];
+            int* duration = &durations[position(i) * width];
+            
+            double low = task.optimistic;
+            double mode = task.duration;
+            double high = task.pessimistic;
+            
+            for(int s = 0; s < width; ++s)
+            {
+                if(high <= low)
+                {
+                    duration[s] = task.duration;
+                    continue;
+                }
+                
+                // Uniform in [0, 1) from the 53 high bits of the engine, whose output is fixed
+                // by the standard, unlike the algorithm of uniform_real_distribution: the
+                // result is the same with every standard library
+                double u = (random() >> 11) * (1.0 / (1LL << 53));
+                double x;
+                
+                if(u < (mode - low) / (high - low))
+                    x = low + sqrt(u * (high - low) * (mode - low));
+                else
+                    x = high - sqrt((1 - u) * (high - low) * (high - mode));
+                
+                duration[s] = (int) lround(x);
+            }
+        }
+        
+        // Earliest start times, following the topological order
+        fill(starts.begin(), starts.end(), 0);
+        
+        for(int k = 0; k < n; ++k)
+        {
+            Relations current_childs = childs(order[k]);
+            
+            int* start = &starts[order[k] * width];
+            int* duration = &durations[order[k] * width];
+            int min_end[BLOCK];
+            
+            for(int s = 0; s < width; ++s)
+                min_end[s] = start[s] + duration[s];
+            
+            for(int i = 0; i < current_childs.size(); ++i)
+            {
+                int* child = &starts[current_childs[i] * width];
+                
+                for(int s = 0; s < width; ++s)
+                    child[s] = max(child[s], min_end[s]);
+            }
+        }
+        
+        // Project length is the earliest end time of the END task
+        int* end_start = &starts[(n - 1) * width];
+        int* end_duration = &durations[(n - 1) * width];
+        
+        for(int s = 0; s < width; ++s)
+            lengths[s] = end_start[s] + end_duration[s];
+        
+        // Latest end times, following the reverse topological order
+        for(int i = 0; i < n; ++i)
+            for(int s = 0; s < width; ++s)
+                ends[i * width + s] = lengths[s];
+        
+        for(int k = n - 1; k >= 0; --k)
+        {
+            Relations current_prerequisites = prerequisites(order[k]);
+            
+            int* end = &ends[order[k] * width];
+            int* duration = &durations[order[k] * width];
+            int max_start[BLOCK];
+            
+            for(int s = 0; s < width; ++s)
+                max_start[s] = end[s] - duration[s];
+            
+            for(int i = 0; i < current_prerequisites.size(); ++i)
+            {
+                int* prerequisite = &ends[current_prerequisites[i] * width];
+                
+                for(int s = 0; s < width; ++s)
+                    prerequisite[s] = min(prerequisite[s], max_start[s]);
+            }
+        }
+        
+        // A task is critical when its earliest end time is equal to its latest end time
+        for(int i = 0; i < n; ++i)
+        {
+            int count = 0;
+            
+            for(int s = 0; s < valid; ++s)
+                count += starts[i * width + s] + durations[i * width + s] == ends[i * width + s];
+            
+            critical[i] += count;
+        }
     }
     
     /**
@@ -426,54 +2725,306 @@ private:
      * TASK_ID EARLY_START_TIME EARLY_END_TIME LATEST_START_TIME LATEST_END_TIME CRITICAL?
      * 
      * Pads every column to 6 characters (fills with spaces), except the last one.
+     * Tasks are printed in the order they were read, even after renumber().
      * 
      * Average cost:
      * O(n), where n = tasks.size()
+     * 
+     * @param out Output stream
      */
-    void print()
+    void print(ostream& out = cout)
     {
         // Pad left
-        cout << left;
+        out << left;
         
         for(int i = 0; i < tasks.size(); ++i)
         {
-            Task& task = tasks[i];
+            Task& task = tasks[position(i)];
             
             int min_end = task.min_start + task.duration;
             
-            cout << setw(6) << task.id;
-            cout << setw(6) << task.min_start;
-            cout << setw(6) << min_end;
-            cout << setw(6) << task.max_end - task.duration;
-            cout << setw(6) << task.max_end;
+            out << setw(6) << task.id;
+            out << setw(6) << task.min_start;
+            out << setw(6) << min_end;
+            out << setw(6) << task.max_end - task.duration;
+            out << setw(6) << task.max_end;
             
             if(min_end == task.max_end)
-                cout << '*';
+                out << '*';
             
-            cout << endl;
+            out << endl;
         }
     }
 };
 
+/**
+ * Stream buffer that appends the characters written to a string. Unlike an ostringstream,
+ * whose str() returns a copy, the string can be taken with swap() and its memory reused.
+ */
+class StringBuffer : public streambuf
+{
+public:
+    /**
+     * Creates a buffer that appends to text.
+     * @param text Destination string
+     */
+    StringBuffer(string& text) : text(text)
+    { }
+    
+protected:
+    int_type overflow(int_type c)
+    {
+        if(c != traits_type::eof())
+            text.push_back(c);
+        
+        return traits_type::not_eof(c);
+    }
+    
+    streamsize xsputn(const char* data, streamsize size)
+    {
+        text.append(data, size);
+        return size;
+    }
+    
+private:
+    string& text;
+};
+
+/**
+ * Plans many independent projects, read one after the other from the input stream, with a
+ * pool of threads. Every thread reuses one Project for all the projects it plans (see
+ * Project::clear()), and takes the next unplanned project when it finishes one.
+ * The output is the concatenation of the outputs of the projects, in the order they were
+ * read, exactly as if every project was planned by a different run.
+ * 
+ * The whole input is loaded and split first: a project is its number of tasks n followed
+ * by the tokens until its n-th "@" token, and it is read in place (see Project::read()).
+ * Every thread writes the output of a project to a buffer that is handed to the main
+ * thread, which writes it as soon as it and all the previous ones are planned, and
+ * returns it to be reused by the next projects.
+ * 
+ * Average cost: O(N + M) divided among the threads
+ * Where N is the total number of tasks and M the total number of relations.
+ * 
+ * @param threads Number of threads
+ */
+void plan_batch(int threads)
+{
+    // Load the whole input
+    string text;
+    char buffer[1 << 16];
+    size_t size;
+    
+    while((size = fread(buffer, 1, sizeof(buffer), stdin)) > 0)
+        text.append(buffer, size);
+    
+    // Reads the next token, returns its length (0 at the end of the input)
+    size_t i = 0;
+    size_t first;
+    auto next = [&]()
+    {
+        while(i < text.size() and isspace((unsigned char) text[i]))
+            ++i;
+        
+        first = i;
+        
+        while(i < text.size() and not isspace((unsigned char) text[i]))
+            ++i;
+        
+        return i - first;
+    };
+    
+    // Project p is text[bounds[p]..bounds[p+1]-1]
+    vector<size_t> bounds(1, 0);
+    
+    while(next() > 0)
+    {
+        int n = atoi(text.c_str() + first);
+        
+        for(int records = 0; records < n and next() > 0; )
+            if(i - first == 1 and text[first] == '@')
+                ++records;
+        
+        bounds.push_back(i);
+    }
+    
+    int projects = bounds.size() - 1;
+    STAT_ADD(projects, projects);
+    
+    // Output of every project, available when ready[p] is true, and buffers of the outputs
+    // already written
+    vector<string> outputs(projects);
+    vector<bool> ready(projects, false);
+    vector<string> buffers;
+    
+    mutex lock;
+    condition_variable planned;
+    atomic<int> pending(0);
+    vector<thread> workers;
+    
+    for(int t = 0; t < threads; ++t)
+    {
+        workers.push_back(thread([&]()
+        {
+            STAT_IGNORE();
+            
+            Project project;
+            string output;
+            StringBuffer buffer(output);
+            ostream out(&buffer);
+            int p;
+            
+            while((p = pending++) < projects)
+            {
+                project.clear();
+                project.read(text.data() + bounds[p], text.data() + bounds[p+1]);
+                project.plan(out);
+                
+                {
+                    lock_guard<mutex> guard(lock);
+                    outputs[p].swap(output);
+                    ready[p] = true;
+                    
+                    // Take a buffer already written, if any
+                    if(!buffers.empty())
+                    {
+                        output.swap(buffers.back());
+                        buffers.pop_back();
+                    }
+                }
+                
+                output.clear();
+                
+                planned.notify_all();
+            }
+        }));
+    }
+    
+    // Write the outputs in order
+    string output;
+    
+    for(int p = 0; p < projects; ++p)
+    {
+        {
+            unique_lock<mutex> guard(lock);
+            planned.wait(guard, [&]() { return ready[p]; });
+            output.swap(outputs[p]);
+        }
+        
+        cout << output;
+        
+        lock_guard<mutex> guard(lock);
+        buffers.push_back(string());
+        buffers.back().swap(output);
+    }
+    
+    for(int t = 0; t < threads; ++t)
+        workers[t].join();
+}
+
 /**
  * Reads a project planning problem and tries to solve it.
  * If the project contains cycles prints a warning message.
  * If the project does not contain any cycle the planning table of the project is printed.
  * 
+ * Options:
+ *   --simulate s  Prints the result of simulate() with s scenarios instead of the table
+ *   --threads t   Number of threads of the simulation and of read_parallel() (1 by default,
+ *                 at least 1)
+ *   --seed x      Seed of the simulation (1 by default)
+ *   --shards k    Plans the project with plan_sharded() using k worker processes
+ *   --renumber    Renumbers the tasks in topological order before the simulation
+ *                 (see Project::renumber()). The output does not change.
+ *   --query       Answers the queries that follow the project with Project::query()
+ *   --batch       Plans all the projects of the input with plan_batch(), using the number
+ *                 of threads of --threads
+ * 
  * Average cost:
  * read() + plan() = O(n + m) + O(n + m) = O(n + m)
  * Where n is the number of tasks of the project and m is the number of prerequisites relations
  * between tasks of the project.
  * If m >> n then the cost is: O(m)
  * 
+ * @param argc Number of arguments
+ * @param argv Arguments
  * @return Execution status
  */
-int main()
+int main(int argc, char* argv[])
 {
+    int scenarios = 0;
+    int threads = 1;
+    unsigned long seed = 1;
+    int shards = 1;
+    bool topological = false;
+    bool queries = false;
+    bool batch = false;
+    
+    for(int i = 1; i < argc; ++i)
+    {
+        string option = argv[i];
+        
+        if(option == "--renumber")
+            topological = true;
+        
+        else if(option == "--query")
+            queries = true;
+        
+        else if(option == "--batch")
+            batch = true;
+        
+        else if(i + 1 == argc)
+            break;
+        
+        else if(option == "--simulate")
+            scenarios = atoi(argv[++i]);
+        
+        else if(option == "--threads")
+            threads = max(1, atoi(argv[++i]));
+        
+        else if(option == "--seed")
+            seed = strtoul(argv[++i], NULL, 10);
+        
+        else if(option == "--shards")
+            shards = atoi(argv[++i]);
+    }
+    
+    if(batch)
+    {
+        STAT_PHASE(batch);
+        plan_batch(threads);
+        return 0;
+    }
+    
     Project project;
     
-    project.read();
-    project.plan();
+    if(shards > 1)
+    {
+        STAT_PHASE(sharded);
+        project.plan_sharded(shards);
+        return 0;
+    }
+    
+    {
+        STAT_PHASE(read);
+        
+        // read_parallel() reads the whole input, queries must be read after the project
+        if(threads > 1 and !queries)
+            project.read_parallel(threads);
+        else
+            project.read();
+    }
+    
+    if(queries)
+        project.query();
+    
+    else if(scenarios > 0)
+    {
+        STAT_PHASE(simulate);
+        STAT_ADD(scenarios, scenarios);
+        project.simulate(scenarios, threads, seed, topological);
+    }
+    else
+        project.plan();
     
     return 0;
 }